@@ -0,0 +1,626 @@
+// Tile2DBenchmark: renders synthetic scenes with the editor's own grid and entity code in
+// a headless context and writes frame-time percentiles as JSON. Run it from the repository
+// root like the editor (shaders and assets are loaded from src/).
+//
+//   Tile2DBenchmark [--suite render] [--tiles 1000,10000,...] [--modes batched,chunked,...]
+//                   [--layers N] [--frames N] [--warmup N] [--seed N]
+//                   [--width W] [--height H] [--visible] [--out results.json]
+//
+//   Tile2DBenchmark --suite startup [--width W] [--height H] [--visible]
+//       Constructs the editor with progressive texture streaming, then with blocking loads,
+//       and reports time to first frame, time to fully loaded and the worst frame between.
+//
+//   Tile2DBenchmark --suite compress [--images src/assets] [--max-rmse 8]
+//       Encodes every PNG with BlockCompressor, decodes it on the CPU and compares against
+//       the source. Exits with 1 if any image is above the error bound or not deterministic.
+//
+//   Tile2DBenchmark --suite decode [--images src/assets] [--threads 1,2,4,...] [--repeat N]
+//       Loads every PNG through AssetManager with each decode pool size and reports the
+//       median wall time and the speedup over the first size.
+//
+//   Tile2DBenchmark --suite pack [--images src/assets] [--pack benchmark.t2dpack] [--repeat N]
+//       Bakes the images into a fresh AssetPack, updates it again with nothing changed, then
+//       compares loading every texture from the pack against decoding the PNGs.
+//
+//   Tile2DBenchmark --suite kernels [--repeat N]
+//       Checks every ImageKernels variant the CPU supports byte for byte against the scalar
+//       one on random images of odd sizes, then times each on a 2048x2048 image. Exits with 1
+//       on any mismatch.
+//
+//   Tile2DBenchmark --suite memory [--images src/assets] [--pixel-arena off]
+//       Loads every PNG through AssetManager once and frees the CPU copies, reporting heap
+//       allocations and peak / current RSS. Peak RSS only grows within a process, so compare
+//       the pixel arena against per-image allocations with two runs.
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+#include "../editor/Editor.h"
+#include "../editor/AssetManager.h"
+#include "../editor/TextureData.h"
+#include "../editor/BlockCompression.h"
+#include "../editor/AssetPack.h"
+#include "../editor/ImageKernels.h"
+#include "../editor/PixelArena.h"
+#include "../window.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <algorithm>
+#include <thread>
+#include <random>
+#include <functional>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Counts every allocation through operator new, for the memory suite
+static std::atomic<uint64_t> s_heapAllocations{ 0 };
+
+void* operator new(std::size_t size) {
+    s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size ? size : 1)) return block;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+using json = nlohmann::json;
+
+namespace {
+    struct Options {
+        std::string suite = "render";
+        std::string outPath = "benchmark_results.json";
+        int width = 1600;
+        int height = 900;
+        bool visible = false;
+        RenderBenchmarkConfig render;
+        std::string imageDir = "src/assets";
+        double maxRmse = 8.0;
+        std::vector<unsigned int> decodeThreads; // Empty: powers of two up to the core count
+        int repeat = 3;
+        std::string packPath = "benchmark.t2dpack";
+        bool pixelArena = true;
+    };
+
+    std::vector<std::string> splitList(const std::string& text) {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, ',')) {
+            if (!part.empty()) parts.push_back(part);
+        }
+        return parts;
+    }
+
+    bool parseMode(const std::string& name, RenderMode& mode) {
+        for (RenderMode candidate : { RenderMode::Batched, RenderMode::Instanced, RenderMode::Chunked, RenderMode::Array }) {
+            if (name == RenderModeName(candidate)) {
+                mode = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool parseArgs(int argc, char** argv, Options& options) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--visible") {
+                options.visible = true;
+                continue;
+            }
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << "\n";
+                return false;
+            }
+            std::string value = argv[++i];
+
+            try {
+                if (arg == "--suite") options.suite = value;
+                else if (arg == "--out") options.outPath = value;
+                else if (arg == "--width") options.width = std::stoi(value);
+                else if (arg == "--height") options.height = std::stoi(value);
+                else if (arg == "--layers") options.render.layers = std::stoi(value);
+                else if (arg == "--frames") options.render.frames = std::stoi(value);
+                else if (arg == "--warmup") options.render.warmupFrames = std::stoi(value);
+                else if (arg == "--seed") options.render.seed = static_cast<unsigned int>(std::stoul(value));
+                else if (arg == "--images") options.imageDir = value;
+                else if (arg == "--max-rmse") options.maxRmse = std::stod(value);
+                else if (arg == "--repeat") options.repeat = std::max(1, std::stoi(value));
+                else if (arg == "--pack") options.packPath = value;
+                else if (arg == "--pixel-arena") options.pixelArena = value != "off";
+                else if (arg == "--threads") {
+                    options.decodeThreads.clear();
+                    for (auto& count : splitList(value)) options.decodeThreads.push_back(std::max(1, std::stoi(count)));
+                }
+                else if (arg == "--tiles") {
+                    options.render.tileCounts.clear();
+                    for (auto& count : splitList(value)) options.render.tileCounts.push_back(std::stoi(count));
+                }
+                else if (arg == "--modes") {
+                    options.render.modes.clear();
+                    for (auto& name : splitList(value)) {
+                        RenderMode mode;
+                        if (!parseMode(name, mode)) {
+                            std::cerr << "Unknown render mode: " << name << "\n";
+                            return false;
+                        }
+                        options.render.modes.push_back(mode);
+                    }
+                }
+                else {
+                    std::cerr << "Unknown option: " << arg << "\n";
+                    return false;
+                }
+            }
+            catch (const std::exception&) {
+                std::cerr << "Bad value for " << arg << ": " << value << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* glString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "unknown";
+    }
+
+    json runRenderSuite(Window& window, const Options& options) {
+        TextureStreamSettings textures;
+        textures.progressive = false;
+        Editor editor(window, textures);
+        std::vector<RenderBenchmarkResult> results = editor.runRenderBenchmark(options.render);
+
+        json runs = json::array();
+        for (auto& result : results) {
+            runs.push_back({
+                {"tiles", result.tiles},
+                {"layers", result.layers},
+                {"mode", RenderModeName(result.mode)},
+                {"frames", result.frames},
+                {"mean_ms", result.meanMs},
+                {"p50_ms", result.p50Ms},
+                {"p90_ms", result.p90Ms},
+                {"p95_ms", result.p95Ms},
+                {"p99_ms", result.p99Ms},
+                {"max_ms", result.maxMs},
+                {"avg_draw_calls", result.avgDrawCalls},
+                {"avg_visible", result.avgVisible}
+            });
+        }
+        return runs;
+    }
+
+    json runStartupSuite(Window& window) {
+        json runs = json::array();
+        for (bool progressive : { true, false }) {
+            TextureStreamSettings textures;
+            textures.progressive = progressive;
+            StartupBenchmarkResult result;
+            {
+                Editor editor(window, textures);
+                result = editor.runStartupBenchmark();
+            }
+            runs.push_back({
+                {"mode", progressive ? "progressive" : "blocking"},
+                {"textures", result.textures},
+                {"first_frame_ms", result.firstFrameMs},
+                {"fully_loaded_ms", result.fullyLoadedMs},
+                {"frames", result.frames},
+                {"max_frame_ms", result.maxFrameMs}
+            });
+        }
+        return runs;
+    }
+
+    std::vector<std::string> listImages(const std::string& directory) {
+        std::vector<std::string> paths;
+        std::error_code error;
+        for (auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".png")
+                paths.push_back(entry.path().string());
+        }
+        if (error) std::cerr << "Could not read " << directory << "\n";
+        std::sort(paths.begin(), paths.end());
+        return paths;
+    }
+
+    json runCompressSuite(const Options& options, bool& passed) {
+        using Clock = std::chrono::steady_clock;
+        json runs = json::array();
+
+        std::vector<std::string> paths = listImages(options.imageDir);
+        for (auto& path : paths) {
+            TextureData texture;
+            if (!texture.LoadFromFile(path)) continue;
+
+            BlockFormat format = BlockCompressor::ChooseFormat(texture.pixels.data(), texture.width, texture.height);
+            auto start = Clock::now();
+            std::vector<unsigned char> encoded = BlockCompressor::Encode(texture.pixels.data(), texture.width, texture.height, format);
+            double encodeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            bool deterministic = encoded == BlockCompressor::Encode(texture.pixels.data(), texture.width, texture.height, format);
+            BlockCompressor::ErrorStats stats = BlockCompressor::Measure(texture.pixels.data(), texture.width, texture.height, format);
+            bool pass = deterministic && stats.rmse <= options.maxRmse;
+            passed = passed && pass;
+
+            runs.push_back({
+                {"image", path},
+                {"width", texture.width},
+                {"height", texture.height},
+                {"format", format == BlockFormat::BC1 ? "bc1" : "bc3"},
+                {"encode_ms", encodeMs},
+                {"rgba_bytes", texture.pixels.size()},
+                {"compressed_bytes", encoded.size()},
+                {"rmse", stats.rmse},
+                {"max_error", stats.maxError},
+                {"deterministic", deterministic},
+                {"pass", pass}
+            });
+            if (!pass)
+                std::cerr << "Compress: " << path << " failed (rmse " << stats.rmse << ")\n";
+        }
+        return runs;
+    }
+
+    json runDecodeSuite(const Options& options) {
+        using Clock = std::chrono::steady_clock;
+        json runs = json::array();
+
+        std::vector<std::string> paths = listImages(options.imageDir);
+        std::vector<unsigned int> threadCounts = options.decodeThreads;
+        if (threadCounts.empty()) {
+            unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+            for (unsigned int count = 1; count < cores; count *= 2) threadCounts.push_back(count);
+            threadCounts.push_back(cores);
+        }
+
+        // Decode only: compression is a separate cost with its own cache
+        AssetManager::SetTextureCompression(false);
+
+        double baselineMs = 0.0;
+        for (unsigned int threads : threadCounts) {
+            std::vector<double> samples;
+            size_t decodedBytes = 0;
+            int loaded = 0;
+
+            for (int run = 0; run < options.repeat; run++) {
+                AssetManager::Init(threads);
+                auto start = Clock::now();
+                for (auto& path : paths) AssetManager::LoadTextureAsync(path);
+                AssetManager::WaitForTextureLoads();
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+                decodedBytes = 0;
+                loaded = 0;
+                for (auto& path : paths) {
+                    if (const TextureData* texture = AssetManager::GetTextureData(path)) {
+                        decodedBytes += texture->pixels.size();
+                        loaded++;
+                    }
+                }
+                AssetManager::Shutdown(); // No GL objects were made, so this needs no context
+            }
+
+            std::sort(samples.begin(), samples.end());
+            double medianMs = samples[samples.size() / 2];
+            if (runs.empty()) baselineMs = medianMs;
+
+            runs.push_back({
+                {"threads", threads},
+                {"images", loaded},
+                {"decoded_mb", decodedBytes / (1024.0 * 1024.0)},
+                {"median_ms", medianMs},
+                {"min_ms", samples.front()},
+                {"max_ms", samples.back()},
+                {"speedup", medianMs > 0.0 ? baselineMs / medianMs : 0.0}
+            });
+            std::cout << "Decode: " << threads << " thread(s), " << loaded << " images: " << medianMs << " ms\n";
+        }
+        return runs;
+    }
+
+    json runPackSuite(const Options& options) {
+        using Clock = std::chrono::steady_clock;
+        json report;
+        std::vector<std::string> paths = listImages(options.imageDir);
+        int compressMinPixels = AssetManager::kCompressMinPixels;
+
+        std::error_code error;
+        std::filesystem::remove(options.packPath, error);
+        AssetPack::UpdateStats cold, warm;
+        AssetPack::Update(options.packPath, paths, compressMinPixels, &cold);
+        AssetPack::Update(options.packPath, paths, compressMinPixels, &warm);
+        report["bake"] = { {"ms", cold.ms}, {"rebuilt", cold.rebuilt}, {"failed", cold.failed} };
+        report["up_to_date"] = { {"ms", warm.ms}, {"reused", warm.reused}, {"written", warm.written} };
+        report["pack_mb"] = std::filesystem::file_size(options.packPath, error) / (1024.0 * 1024.0);
+
+        // Every texture into AssetManager's CPU store, from the pack or from the PNGs.
+        // The pack run includes its (no-op) update, like an editor start does.
+        json loads = json::array();
+        for (bool fromPack : { false, true }) {
+            std::vector<double> samples;
+            int loaded = 0;
+            for (int run = 0; run < options.repeat; run++) {
+                AssetManager::Init();
+                auto start = Clock::now();
+                if (fromPack) AssetManager::OpenAssetPack(options.packPath, paths);
+                for (auto& path : paths) AssetManager::LoadTextureAsync(path);
+                AssetManager::WaitForTextureLoads();
+                samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+                loaded = 0;
+                for (auto& path : paths) {
+                    if (AssetManager::GetTextureData(path)) loaded++;
+                }
+                AssetManager::Shutdown(); // No GL objects were made, so this needs no context
+            }
+
+            std::sort(samples.begin(), samples.end());
+            loads.push_back({
+                {"source", fromPack ? "pack" : "png"},
+                {"images", loaded},
+                {"median_ms", samples[samples.size() / 2]},
+                {"min_ms", samples.front()},
+                {"max_ms", samples.back()}
+            });
+            std::cout << "Pack: loaded " << loaded << " images from " << (fromPack ? "the pack" : "PNGs")
+                << " in " << samples[samples.size() / 2] << " ms\n";
+        }
+        report["loads"] = loads;
+        return report;
+    }
+}
+
+namespace {
+    struct ProcessMemory {
+        size_t currentBytes = 0;
+        size_t peakBytes = 0;
+    };
+
+    ProcessMemory processMemory() {
+        ProcessMemory memory;
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            memory.currentBytes = counters.WorkingSetSize;
+            memory.peakBytes = counters.PeakWorkingSetSize;
+        }
+#else
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0)
+            memory.peakBytes = static_cast<size_t>(usage.ru_maxrss) * 1024; // KB on Linux
+        std::ifstream statm("/proc/self/statm");
+        size_t totalPages = 0, residentPages = 0;
+        if (statm >> totalPages >> residentPages)
+            memory.currentBytes = residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+        return memory;
+    }
+
+    uint64_t allocationCount() {
+        return s_heapAllocations.load(std::memory_order_relaxed) + PixelArena::SystemAllocations();
+    }
+
+    json runMemorySuite(const Options& options) {
+        using Clock = std::chrono::steady_clock;
+        const double mb = 1024.0 * 1024.0;
+
+        // Decode only, like the decode suite; the pack would skip decoding altogether
+        PixelArena::SetEnabled(options.pixelArena);
+        AssetManager::SetTextureCompression(false);
+        std::vector<std::string> paths = listImages(options.imageDir);
+        AssetManager::Init();
+
+        ProcessMemory before = processMemory();
+        uint64_t allocationsBefore = allocationCount();
+        auto start = Clock::now();
+        for (auto& path : paths) AssetManager::LoadTextureAsync(path);
+        AssetManager::WaitForTextureLoads();
+        double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        uint64_t loadAllocations = allocationCount() - allocationsBefore;
+        ProcessMemory loaded = processMemory();
+
+        AssetManager::FreeCPUDataForLoadedTextures();
+        ProcessMemory freed = processMemory();
+        AssetManager::Shutdown();
+
+        std::cout << "Memory: " << paths.size() << " images, " << loadAllocations << " allocations, peak RSS "
+            << loaded.peakBytes / mb << " MB, " << freed.currentBytes / mb << " MB after freeing\n";
+        return {
+            {"pixel_arena", options.pixelArena},
+            {"images", paths.size()},
+            {"load_ms", loadMs},
+            {"allocations", loadAllocations},
+            {"rss_before_mb", before.currentBytes / mb},
+            {"rss_loaded_mb", loaded.currentBytes / mb},
+            {"rss_freed_mb", freed.currentBytes / mb},
+            {"peak_rss_mb", loaded.peakBytes / mb}
+        };
+    }
+
+    // One kernel run over `input` into `output` (both sized for the image); output is
+    // compared across ISAs
+    struct KernelCase {
+        const char* name;
+        std::function<void(const std::vector<uint8_t>& input, std::vector<uint8_t>& output, int width, int height)> run;
+    };
+
+    std::vector<KernelCase> kernelCases() {
+        std::vector<KernelCase> cases;
+        cases.push_back({ "flip", [](const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int w, int h) {
+            ImageKernels::FlipVertical(in.data(), out.data(), static_cast<size_t>(w) * 4, h);
+        } });
+        for (int channels = 1; channels <= 3; channels++) {
+            static const char* names[] = { "", "expand_grey", "expand_grey_alpha", "expand_rgb" };
+            cases.push_back({ names[channels], [channels](const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int w, int h) {
+                ImageKernels::ExpandToRGBA(in.data(), channels, out.data(), static_cast<size_t>(w) * h);
+            } });
+        }
+        cases.push_back({ "premultiply", [](const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int w, int h) {
+            std::copy(in.begin(), in.begin() + static_cast<size_t>(w) * h * 4, out.begin());
+            ImageKernels::PremultiplyAlpha(out.data(), static_cast<size_t>(w) * h);
+        } });
+        cases.push_back({ "downsample", [](const std::vector<uint8_t>& in, std::vector<uint8_t>& out, int w, int h) {
+            ImageKernels::Downsample2x(in.data(), w, h, out.data());
+        } });
+        return cases;
+    }
+
+    json runKernelsSuite(const Options& options, bool& passed) {
+        using Clock = std::chrono::steady_clock;
+        using Isa = ImageKernels::Isa;
+
+        std::vector<Isa> isas;
+        for (Isa isa : { Isa::Scalar, Isa::SSE2, Isa::AVX2 }) {
+            if (isa <= ImageKernels::Supported()) isas.push_back(isa);
+        }
+
+        std::mt19937 rng(1234);
+        auto randomImage = [&rng](int width, int height) {
+            std::vector<uint8_t> pixels(static_cast<size_t>(width) * height * 4);
+            for (auto& byte : pixels) byte = static_cast<uint8_t>(rng());
+            return pixels;
+        };
+
+        json runs = json::array();
+        for (const KernelCase& kernel : kernelCases()) {
+            // Bit-exact: odd sizes hit every vector loop's scalar tail
+            bool exact = true;
+            for (int trial = 0; trial < 200 && exact; trial++) {
+                int width = 1 + static_cast<int>(rng() % 97);
+                int height = 1 + static_cast<int>(rng() % 33);
+                std::vector<uint8_t> input = randomImage(width, height);
+                std::vector<uint8_t> reference(input.size()), output(input.size());
+
+                ImageKernels::SetActive(Isa::Scalar);
+                kernel.run(input, reference, width, height);
+                for (Isa isa : isas) {
+                    std::fill(output.begin(), output.end(), 0);
+                    ImageKernels::SetActive(isa);
+                    kernel.run(input, output, width, height);
+                    if (output != reference) {
+                        std::cerr << "Kernels: " << kernel.name << " (" << ImageKernels::IsaName(isa) << ") differs from scalar at "
+                            << width << "x" << height << "\n";
+                        exact = false;
+                    }
+                }
+            }
+            passed = passed && exact;
+
+            const int size = 2048;
+            std::vector<uint8_t> input = randomImage(size, size);
+            std::vector<uint8_t> output(input.size());
+            double scalarMs = 0.0;
+            for (Isa isa : isas) {
+                ImageKernels::SetActive(isa);
+                std::vector<double> samples;
+                for (int run = 0; run < options.repeat; run++) {
+                    auto start = Clock::now();
+                    kernel.run(input, output, size, size);
+                    samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                }
+                std::sort(samples.begin(), samples.end());
+                double medianMs = samples[samples.size() / 2];
+                if (isa == Isa::Scalar) scalarMs = medianMs;
+
+                runs.push_back({
+                    {"kernel", kernel.name},
+                    {"isa", ImageKernels::IsaName(isa)},
+                    {"median_ms", medianMs},
+                    {"mpixels_per_s", medianMs > 0.0 ? size * size / (medianMs * 1000.0) : 0.0},
+                    {"speedup", medianMs > 0.0 ? scalarMs / medianMs : 0.0},
+                    {"bit_exact", exact}
+                });
+                std::cout << "Kernels: " << kernel.name << " " << ImageKernels::IsaName(isa) << ": " << medianMs << " ms\n";
+            }
+        }
+        ImageKernels::SetActive(ImageKernels::Supported());
+        return runs;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseArgs(argc, argv, options)) return 1;
+
+    json report;
+    report["suite"] = options.suite;
+    bool passed = true;
+
+    if (options.suite == "render") {
+        Window window(options.width, options.height, "Tile2D Benchmark",
+            options.visible ? WindowMode::Visible : WindowMode::Headless);
+        report["renderer"] = glString(GL_RENDERER);
+        report["gl_version"] = glString(GL_VERSION);
+        report["width"] = options.width;
+        report["height"] = options.height;
+        report["frames"] = options.render.frames;
+        report["warmup_frames"] = options.render.warmupFrames;
+        report["seed"] = options.render.seed;
+        report["results"] = runRenderSuite(window, options);
+    }
+    else if (options.suite == "startup") {
+        Window window(options.width, options.height, "Tile2D Benchmark",
+            options.visible ? WindowMode::Visible : WindowMode::Headless);
+        report["renderer"] = glString(GL_RENDERER);
+        report["gl_version"] = glString(GL_VERSION);
+        report["width"] = options.width;
+        report["height"] = options.height;
+        report["results"] = runStartupSuite(window);
+    }
+    else if (options.suite == "compress") {
+        // CPU only, no GL context needed
+        report["max_rmse"] = options.maxRmse;
+        report["results"] = runCompressSuite(options, passed);
+        report["passed"] = passed;
+    }
+    else if (options.suite == "decode") {
+        report["repeat"] = options.repeat;
+        report["hardware_threads"] = std::thread::hardware_concurrency();
+        report["results"] = runDecodeSuite(options);
+    }
+    else if (options.suite == "kernels") {
+        report["supported_isa"] = ImageKernels::IsaName(ImageKernels::Supported());
+        report["results"] = runKernelsSuite(options, passed);
+        report["passed"] = passed;
+    }
+    else if (options.suite == "memory") {
+        report["results"] = runMemorySuite(options);
+    }
+    else if (options.suite == "pack") {
+        report["repeat"] = options.repeat;
+        report["results"] = runPackSuite(options);
+    }
+    else {
+        std::cerr << "Unknown suite: " << options.suite << "\n";
+        return 1;
+    }
+
+    std::ofstream file(options.outPath);
+    if (!file) {
+        std::cerr << "Could not write " << options.outPath << "\n";
+        return 1;
+    }
+    file << report.dump(2) << "\n";
+    std::cout << "Benchmark: wrote " << options.outPath << "\n";
+    return passed ? 0 : 1;
+}
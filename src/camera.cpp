@@ -20,6 +20,17 @@ void Camera::resize(int width, int height) {
     m_viewHeight = height;
 }
 
+/**
+ * Set viewport: Places the camera's view inside the window, in window pixels with a
+ * top-left origin (the editor view starts right of the left panel).
+ * Also resizes the view, so it replaces a separate resize() call.
+ */
+void Camera::setViewport(int x, int y, int width, int height) {
+    m_viewX = x;
+    m_viewY = y;
+    resize(width, height);
+}
+
 /**
  * Set position: Sets the camera's world position (center of the view).
  * The camera looks at this point in world space. Used for panning/scrolling.
@@ -91,18 +102,48 @@ float Camera::getVirtualHeight() const {
  * This matrix transforms world coordinates to clip space. Called every frame for rendering.
  */
 glm::mat4 Camera::getProjection() const {
+    glm::vec4 rect = getVisibleRect();
+
+    return glm::ortho(
+        rect.x, rect.z,
+        rect.y, rect.w,
+        -1.0f, 1.0f
+    );
+}
+
+/**
+ * Get visible rect: Returns the world-space area the projection shows, as
+ * (left, bottom, right, top). Uses the same zoom/aspect math as getProjection(),
+ * so anything outside it is off-screen and can be culled.
+ */
+glm::vec4 Camera::getVisibleRect() const {
     float aspect = static_cast<float>(m_viewWidth) / static_cast<float>(m_viewHeight);
 
     // divide by zoom, not multiply
     float halfHeight = (m_virtualHeight * 0.5f) / m_zoom;
     float halfWidth = halfHeight * aspect;
 
-    return glm::ortho(
+    return glm::vec4(
         m_position.x - halfWidth,
-        m_position.x + halfWidth,
         m_position.y - halfHeight,
-        m_position.y + halfHeight,
-        -1.0f, 1.0f
+        m_position.x + halfWidth,
+        m_position.y + halfHeight
+    );
+}
+
+/**
+ * Screen to world: Converts a window pixel position (top-left origin, e.g. from
+ * glfwGetCursorPos) into world space, taking the viewport offset into account.
+ */
+glm::vec2 Camera::screenToWorld(float screenX, float screenY) const {
+    // Normalize to [0, 1] inside the viewport, flipping Y (screen Y grows downwards)
+    float nx = (screenX - m_viewX) / static_cast<float>(m_viewWidth);
+    float ny = 1.0f - (screenY - m_viewY) / static_cast<float>(m_viewHeight);
+
+    glm::vec4 rect = getVisibleRect();
+    return glm::vec2(
+        rect.x + nx * (rect.z - rect.x),
+        rect.y + ny * (rect.w - rect.y)
     );
 }
 
@@ -17,6 +17,13 @@ public:
      * This doesn't change the virtual size, just the actual rendering area.
      */
     void resize(int width, int height);
+
+    /**
+     * Set viewport: Places the camera's view inside the window, in window pixels with a
+     * top-left origin (the editor view starts right of the left panel).
+     * Also resizes the view, so it replaces a separate resize() call.
+     */
+    void setViewport(int x, int y, int width, int height);
     
     /**
      * Set position: Sets the camera's world position (center of the view).
@@ -72,6 +79,19 @@ public:
      */
     glm::mat4 getProjection() const;
 
+    /**
+     * Get visible rect: Returns the world-space area the projection shows, as
+     * (left, bottom, right, top). Uses the same zoom/aspect math as getProjection(),
+     * so anything outside it is off-screen and can be culled.
+     */
+    glm::vec4 getVisibleRect() const;
+
+    /**
+     * Screen to world: Converts a window pixel position (top-left origin, e.g. from
+     * glfwGetCursorPos) into world space, taking the viewport offset into account.
+     */
+    glm::vec2 screenToWorld(float screenX, float screenY) const;
+
 private:
     glm::vec2 m_position = { 0.0f, 0.0f };
     float m_zoom = 1.0f;
@@ -81,4 +101,6 @@ private:
 
     int m_viewWidth;
     int m_viewHeight;
+    int m_viewX = 0;
+    int m_viewY = 0;
 };
\ No newline at end of file
@@ -1,48 +1,232 @@
 #include "AssetManager.h"
+#include "Profiler.h"
+#include "ImageKernels.h"
 #include <glad/glad.h>
 #include <iostream>
 #include <mutex>
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 
+PixelArena AssetManager::m_pixelArena; // Before everything holding TextureData, so it's destroyed last
 std::unordered_map<std::string, TextureData> AssetManager::m_cpuTextures;
 std::unordered_map<std::string, GLuint> AssetManager::m_gpuTextures;
-std::vector<std::future<void>> AssetManager::m_loadingFutures;
+std::vector<AssetManager::TextureSlot> AssetManager::m_slots;
+std::unique_ptr<WorkerPool> AssetManager::m_decodePool;
+CompletionQueue<AssetManager::DecodedTexture> AssetManager::m_completedLoads;
+std::atomic<int> AssetManager::m_pendingLoads{ 0 };
+std::unordered_set<std::string> AssetManager::m_requestedTextures;
+std::unordered_set<std::string> AssetManager::m_failedTextures;
+AssetPack AssetManager::m_pack;
+std::deque<std::string> AssetManager::m_uploadQueue;
+std::unique_ptr<StreamBuffer> AssetManager::m_uploadBuffer;
+GLuint AssetManager::m_placeholderTexture = 0;
+TextureAtlas AssetManager::m_atlas;
+std::vector<GLuint> AssetManager::m_atlasPages;
+GLuint AssetManager::m_atlasRegionVBO = 0;
+GLuint AssetManager::m_atlasRegionTexture = 0;
+GLuint AssetManager::m_textureArray = 0;
+std::unordered_map<std::string, int> AssetManager::m_textureArrayLayers;
+ThumbnailAtlas AssetManager::m_thumbnailAtlas;
+GLuint AssetManager::m_thumbnailTexture = 0;
+CompletionQueue<AssetManager::Thumbnail> AssetManager::m_completedThumbnails;
+uint64_t AssetManager::m_thumbnailGeneration = 0;
+std::atomic<int> AssetManager::m_pendingThumbnails{ 0 };
+bool AssetManager::m_compressTextures = true;
+size_t AssetManager::m_gpuTextureBytes = 0;
+std::unordered_map<std::string, AssetManager::ResidentTexture> AssetManager::m_residency;
+std::list<std::string> AssetManager::m_lru;
+AssetManager::ResidencyStats AssetManager::m_residencyStats;
+uint64_t AssetManager::m_residencyFrame = 0;
 static std::mutex s_textureMutex;
 
-void AssetManager::Init() {
-    
+// Not every glad build defines the S3TC enums (they come from an extension)
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
+static GLenum compressedInternalFormat(BlockFormat format) {
+    return format == BlockFormat::BC1 ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+}
+
+static bool uploadsCompressed(const TextureData& textureData) {
+    return textureData.CompressedBytes() > 0 && AssetManager::IsCompressedFormatSupported(textureData.compressedFormat);
+}
+
+// The bytes glTexImage2D / glCompressedTexImage2D will read for level 0 of this texture
+static const unsigned char* uploadData(const TextureData& textureData) {
+    return uploadsCompressed(textureData) ? textureData.CompressedData() : textureData.RGBA();
+}
+
+static size_t uploadBytes(const TextureData& textureData) {
+    if (uploadsCompressed(textureData)) return textureData.CompressedBytes();
+    return static_cast<size_t>(textureData.width) * textureData.height * 4;
+}
+
+// Served from the asset pack's mapping rather than owned pixels
+static bool isMapped(const TextureData& textureData) {
+    return !textureData.mappedLevels.empty() || textureData.mappedCompressed;
+}
+
+// What the texture will take in VRAM: compressed level 0, or RGBA8 plus a third for mips
+static size_t gpuBytes(const TextureData& textureData) {
+    if (uploadsCompressed(textureData)) return textureData.CompressedBytes();
+    return static_cast<size_t>(textureData.width) * textureData.height * 4 * 4 / 3;
+}
+
+void AssetManager::Init(unsigned int decodeThreads) {
+    if (!m_decodePool)
+        m_decodePool = std::make_unique<WorkerPool>(decodeThreads);
 }
 
 void AssetManager::Shutdown() {
+    // Let decodes in flight finish (the pool joins), then drop whatever they produced
+    m_decodePool.reset();
+    m_completedLoads.drain([](DecodedTexture&) {});
+    m_completedThumbnails.drain([](Thumbnail&) {});
+    m_pendingThumbnails.store(0, std::memory_order_relaxed);
+    m_requestedTextures.clear();
+    m_failedTextures.clear();
+    m_uploadQueue.clear();
+    m_uploadBuffer.reset();
+
+    if (m_placeholderTexture) glDeleteTextures(1, &m_placeholderTexture);
+    m_placeholderTexture = 0;
+
     // Clean up GPU textures
     for (auto& [path, textureID] : m_gpuTextures) {
         glDeleteTextures(1, &textureID);
     }
     m_gpuTextures.clear();
+    m_slots.clear();
     m_cpuTextures.clear();
+    m_pixelArena.reset();
+    m_pack.close(); // After the textures viewing it
+    m_gpuTextureBytes = 0;
+    m_residency.clear();
+    m_lru.clear();
+    m_residencyStats = ResidencyStats{ 0, 0, 0, 0, 0, m_residencyStats.budgetBytes };
+
+    for (GLuint page : m_atlasPages) {
+        glDeleteTextures(1, &page);
+    }
+    m_atlasPages.clear();
+    m_atlas.clear();
+
+    if (m_atlasRegionTexture) glDeleteTextures(1, &m_atlasRegionTexture);
+    if (m_atlasRegionVBO) glDeleteBuffers(1, &m_atlasRegionVBO);
+    m_atlasRegionTexture = 0;
+    m_atlasRegionVBO = 0;
+
+    if (m_textureArray) glDeleteTextures(1, &m_textureArray);
+    m_textureArray = 0;
+    m_textureArrayLayers.clear();
+
+    if (m_thumbnailTexture) glDeleteTextures(1, &m_thumbnailTexture);
+    m_thumbnailTexture = 0;
+    m_thumbnailAtlas.clear();
+    m_thumbnailGeneration++;
 }
 
-std::future<TextureData*> AssetManager::LoadTextureAsync(const std::string& path) {
-    // This runs on a separate thread!
-    return std::async(std::launch::async, [path]() -> TextureData* {
-        std::lock_guard<std::mutex> lock(s_textureMutex);
+void AssetManager::LoadTextureAsync(const std::string& path) {
+    Init();
+    if (m_failedTextures.count(path)) return; // Missing or corrupt: stays the placeholder
+    if (!m_requestedTextures.insert(path).second) return; // Loaded or already on its way
 
-        // Check if already loaded
-        auto it = m_cpuTextures.find(path);
-        if (it != m_cpuTextures.end()) {
-            return &it->second;
+    if (const AssetPack::Entry* entry = m_pack.find(path)) {
+        // Baked already: the texture is a view into the mapping, nothing for the pool to do
+        DecodedTexture result;
+        result.path = path;
+        m_pack.textureView(*entry, result.texture);
+        result.loaded = true;
+        m_completedLoads.push(std::move(result));
+        return;
+    }
+
+    m_pendingLoads.fetch_add(1, std::memory_order_relaxed);
+    bool compress = m_compressTextures;
+    // A batch is freed all at once by FreeCPUDataForLoadedTextures; under a budget textures
+    // are freed one by one as they become resident, so they get their own blocks
+    PixelArena* arena = PixelArena::Enabled() && m_residencyStats.budgetBytes == 0 ? &m_pixelArena : nullptr;
+
+    // Runs on a decode thread: works on its own TextureData and touches no shared state
+    m_decodePool->submit([path, compress, arena]() {
+        DecodedTexture result;
+        result.path = path;
+        {
+            PROFILE_SCOPE("Decode texture");
+            result.loaded = result.texture.LoadFromFile(path, arena);
+            if (result.loaded && compress && result.texture.width * result.texture.height >= kCompressMinPixels)
+                result.texture.LoadOrBuildCompressed();
+            // Compressed uploads are level 0 only; everything else gets its mips here rather
+            // than from glGenerateMipmap on the main thread
+            if (result.loaded && result.texture.compressed.empty())
+                TextureLoader::GenerateMipmapsCPU(result.texture);
         }
 
-        // Load new texture
-        auto& texture = m_cpuTextures[path];
-        if (texture.LoadFromFile(path)) {
-            std::cout << "Loaded texture (CPU): " << path << "\n";
-            return &texture;
+        // Publish before the count drops, so a count of 0 means everything is in the queue
+        m_completedLoads.push(std::move(result));
+        m_pendingLoads.fetch_sub(1, std::memory_order_release);
+        m_pendingLoads.notify_all();
+    });
+}
+
+int AssetManager::ProcessCompletedLoads() {
+    return m_completedLoads.drain([](DecodedTexture& result) {
+        if (!result.loaded) {
+            // Remembered, so a visible tile doesn't queue the same failing decode every frame
+            m_requestedTextures.erase(result.path);
+            m_failedTextures.insert(result.path);
+            return;
         }
+        std::lock_guard<std::mutex> lock(s_textureMutex);
+        m_cpuTextures[result.path] = std::move(result.texture);
+        m_uploadQueue.push_back(result.path);
+        std::cout << "Loaded texture (CPU): " << result.path << "\n";
+    });
+}
 
-        // Failed to load, remove from map
-        m_cpuTextures.erase(path);
-        return nullptr;
-        });
+void AssetManager::WaitForTextureLoads() {
+    for (;;) {
+        ProcessCompletedLoads();
+        int pending = m_pendingLoads.load(std::memory_order_acquire);
+        if (pending == 0) {
+            ProcessCompletedLoads(); // Anything published just before the count reached 0
+            return;
+        }
+        m_pendingLoads.wait(pending, std::memory_order_acquire);
+    }
+}
+
+int AssetManager::PendingTextureLoads() {
+    return m_pendingLoads.load(std::memory_order_relaxed);
+}
+
+unsigned int AssetManager::DecodeThreadCount() {
+    return m_decodePool ? static_cast<unsigned int>(m_decodePool->threadCount()) : 0;
+}
+
+bool AssetManager::OpenAssetPack(const std::string& packPath, const std::vector<std::string>& sources) {
+    PROFILE_SCOPE("Open asset pack");
+    m_pack.close(); // Update may replace the file underneath
+
+    // Baked with the same threshold LoadTextureAsync compresses at
+    if (!AssetPack::Update(packPath, sources, m_compressTextures ? kCompressMinPixels : 0))
+        return false;
+    if (!m_pack.open(packPath))
+        return false;
+
+    std::cout << "Asset pack: " << m_pack.entryCount() << " textures, "
+        << m_pack.fileBytes() / (1024 * 1024) << " MB mapped\n";
+    return true;
+}
+
+bool AssetManager::HasAssetPack() {
+    return m_pack.isOpen();
 }
 
 void AssetManager::UploadAllTexturesToGPU() {
@@ -56,32 +240,286 @@ void AssetManager::UploadAllTexturesToGPU() {
             continue;
         }
 
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        GLuint textureID = createGPUTexture(textureData, uploadData(textureData));
+        makeResident(path, textureData, textureID);
+        std::cout << "Uploaded to GPU: " << path << " [ID: " << textureID << "]\n";
+    }
+    m_uploadQueue.clear();
+    ensurePlaceholder();
 
-        // Set texture parameters
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    std::cout << "Batch upload complete! (~" << m_gpuTextureBytes / (1024 * 1024) << " MB of textures)\n";
+}
+
+int AssetManager::UploadPendingTextures(size_t maxBytes, double maxMs) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    ensurePlaceholder();
+    if (m_uploadQueue.empty()) return 0;
+
+    if (!m_uploadBuffer) {
+        m_uploadBuffer = std::make_unique<StreamBuffer>();
+        m_uploadBuffer->init(kUploadRegionBytes, GL_PIXEL_UNPACK_BUFFER);
+    }
 
-        // Upload to GPU (this is the only GL call per texture now)
+    int uploaded = 0;
+    size_t uploadedBytes = 0;
+    while (!m_uploadQueue.empty()) {
+        const std::string& path = m_uploadQueue.front();
+        auto it = m_cpuTextures.find(path);
+        if (it == m_cpuTextures.end() || m_gpuTextures.count(path)) {
+            m_uploadQueue.pop_front(); // Uploaded by UploadAllTexturesToGPU in the meantime
+            continue;
+        }
+
+        const unsigned char* data = uploadData(it->second);
+        size_t bytes = uploadBytes(it->second);
+        if (uploaded > 0) {
+            double elapsedMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if ((maxBytes > 0 && uploadedBytes + bytes > maxBytes) || (maxMs > 0.0 && elapsedMs >= maxMs))
+                break;
+        }
+
+        // Staged through the PBO, GL returns right away and the copy into the texture
+        // happens on the GPU's schedule; the region's fence keeps it from being reused early.
+        // Pack textures skip it, GL reads them from the mapping without a copy of ours.
+        size_t offset = 0;
+        void* staging = !isMapped(it->second) && bytes <= kUploadRegionBytes ? m_uploadBuffer->map(bytes, 16, offset) : nullptr;
+        const void* source = data;
+        if (staging) {
+            std::memcpy(staging, data, bytes);
+            m_uploadBuffer->unmap();
+            source = reinterpret_cast<const void*>(offset);
+        }
+        else {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        GLuint textureID = createGPUTexture(it->second, source);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Other texture uploads read client memory
+        makeResident(path, it->second, textureID);
+
+        uploadedBytes += bytes;
+        uploaded++;
+        m_uploadQueue.pop_front();
+    }
+
+    m_uploadBuffer->endFrame();
+    Profiler::SetCounter("Texture upload bytes", static_cast<double>(uploadedBytes));
+    return uploaded;
+}
+
+int AssetManager::PendingTextureUploads() {
+    return static_cast<int>(m_uploadQueue.size());
+}
+
+// `source` is client memory, or an offset into the bound GL_PIXEL_UNPACK_BUFFER
+GLuint AssetManager::createGPUTexture(const TextureData& textureData, const void* source) {
+    GLuint textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    // Set texture parameters
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    if (uploadsCompressed(textureData)) {
+        // Level 0 only: GL can't generate mips for compressed data, and the NEAREST
+        // min filter never samples them anyway
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+        glCompressedTexImage2D(
+            GL_TEXTURE_2D, 0, compressedInternalFormat(textureData.compressedFormat),
+            textureData.width, textureData.height, 0,
+            static_cast<GLsizei>(textureData.CompressedBytes()),
+            source
+        );
+    }
+    else {
         glTexImage2D(
             GL_TEXTURE_2D, 0, GL_RGBA8,
             textureData.width, textureData.height,
             0, GL_RGBA, GL_UNSIGNED_BYTE,
-            textureData.pixels.data()
+            source
         );
 
-        // Generate mipmaps on GPU (fast)
-        glGenerateMipmap(GL_TEXTURE_2D);
+        if (textureData.mappedLevels.size() > 1) {
+            // Baked into the asset pack, read straight from the mapping
+            for (size_t level = 1; level < textureData.mappedLevels.size(); level++) {
+                const TextureData::MappedLevel& mip = textureData.mappedLevels[level];
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, mip.width, mip.height,
+                    0, GL_RGBA, GL_UNSIGNED_BYTE, mip.data);
+            }
+        }
+        else if (!textureData.mips.empty()) {
+            // Built on the decode thread; client memory, so level 0's staging buffer goes first
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            int width = textureData.width;
+            int height = textureData.height;
+            for (size_t level = 1; level <= textureData.mips.size(); level++) {
+                width = ImageKernels::NextMipSize(width);
+                height = ImageKernels::NextMipSize(height);
+                glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA8, width, height,
+                    0, GL_RGBA, GL_UNSIGNED_BYTE, textureData.mips[level - 1].data());
+            }
+        }
+        else {
+            // Generate mipmaps on GPU (fast)
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+    }
+    return textureID;
+}
+
+// Caller holds s_textureMutex
+void AssetManager::makeResident(const std::string& path, TextureData& textureData, GLuint textureID) {
+    size_t bytes = gpuBytes(textureData);
+    m_gpuTextures[path] = textureID;
+    if (TextureSlot* slot = slotFor(path)) slot->texture = textureID;
+    m_gpuTextureBytes += bytes;
 
-        m_gpuTextures[path] = textureID;
-        std::cout << "Uploaded to GPU: " << path << " [ID: " << textureID << "]\n";
+    m_lru.push_front(path);
+    m_residency[path] = { m_residencyFrame, bytes, m_lru.begin() };
+    m_residencyStats.resident++;
+    m_residencyStats.residentBytes += bytes;
+
+    // Under a budget nothing is built from the CPU copies (no atlas or array), so they can go now
+    if (m_residencyStats.budgetBytes > 0)
+        textureData.FreeCPUData();
+}
+
+// Caller holds s_textureMutex
+void AssetManager::evict(const std::string& path) {
+    auto it = m_residency.find(path);
+    if (it == m_residency.end()) return;
+
+    auto gpu = m_gpuTextures.find(path);
+    if (gpu != m_gpuTextures.end()) {
+        glDeleteTextures(1, &gpu->second);
+        m_gpuTextures.erase(gpu);
+    }
+    if (TextureSlot* slot = slotFor(path)) slot->texture = 0;
+    m_cpuTextures.erase(path);
+    m_requestedTextures.erase(path); // The next request loads it again
+
+    m_gpuTextureBytes -= it->second.bytes;
+    m_residencyStats.residentBytes -= it->second.bytes;
+    m_residencyStats.resident--;
+    m_residencyStats.evictions++;
+
+    m_lru.erase(it->second.lruPosition);
+    m_residency.erase(it);
+}
+
+void AssetManager::SetResidencyBudget(size_t bytes) {
+    m_residencyStats.budgetBytes = bytes;
+}
+
+GLuint AssetManager::RequestTexture(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(s_textureMutex);
+        auto it = m_residency.find(path);
+        if (it != m_residency.end()) {
+            it->second.lastUsedFrame = m_residencyFrame;
+            m_lru.splice(m_lru.begin(), m_lru, it->second.lruPosition);
+            m_residencyStats.hits++;
+            return m_gpuTextures[path];
+        }
+    }
+
+    // Not resident: start loading it unless that already happened (or failed)
+    if (!m_requestedTextures.count(path) && !m_failedTextures.count(path)) {
+        m_residencyStats.misses++;
+        LoadTextureAsync(path);
     }
+    return GetGPUHandleOrPlaceholder(path);
+}
+
+void AssetManager::UpdateResidency() {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+
+    // Oldest first; stop at the first texture used since the last update
+    size_t budget = m_residencyStats.budgetBytes;
+    while (budget > 0 && m_residencyStats.residentBytes > budget && !m_lru.empty()) {
+        const std::string& oldest = m_lru.back();
+        if (m_residency[oldest].lastUsedFrame >= m_residencyFrame) break;
+        evict(std::string(oldest));
+    }
+    m_residencyFrame++;
+}
+
+const AssetManager::ResidencyStats& AssetManager::GetResidencyStats() {
+    return m_residencyStats;
+}
+
+// Caller holds s_textureMutex (GetGPUHandleOrPlaceholder reads the handle under it)
+void AssetManager::ensurePlaceholder() {
+    if (m_placeholderTexture) return;
+
+    const unsigned char checker[] = {
+        96, 96, 96, 255,   64, 64, 64, 255,
+        64, 64, 64, 255,   96, 96, 96, 255
+    };
+    glGenTextures(1, &m_placeholderTexture);
+    glBindTexture(GL_TEXTURE_2D, m_placeholderTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+}
 
-    std::cout << "Batch upload complete!\n";
+void AssetManager::SetTextureCompression(bool enabled) {
+    m_compressTextures = enabled;
+}
+
+bool AssetManager::IsCompressedFormatSupported(BlockFormat format) {
+    // Formats the driver accepts for glCompressedTexImage2D; asked once
+    static std::vector<GLint> formats;
+    static bool queried = false;
+    if (!queried) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        formats.resize(count);
+        if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        queried = true;
+    }
+    if (format == BlockFormat::None) return false;
+    GLint wanted = static_cast<GLint>(compressedInternalFormat(format));
+    return std::find(formats.begin(), formats.end(), wanted) != formats.end();
+}
+
+size_t AssetManager::GetGPUTextureBytes() {
+    return m_gpuTextureBytes;
+}
+
+AssetManager::TextureSlot* AssetManager::slotFor(const std::string& path) {
+    AssetId id = AssetRegistry::FindPath(path);
+    return id != kNoAsset ? &slotFor(id) : nullptr;
+}
+
+AssetManager::TextureSlot& AssetManager::slotFor(AssetId id) {
+    if (id >= m_slots.size()) m_slots.resize(AssetRegistry::Count());
+    return m_slots[id];
+}
+
+const AssetManager::TextureSlot& AssetManager::GetTextureSlot(AssetId id) {
+    static const TextureSlot empty;
+    return id < m_slots.size() ? m_slots[id] : empty;
+}
+
+GLuint AssetManager::GetGPUHandleOrPlaceholder(AssetId id) {
+    GLuint texture = GetTextureSlot(id).texture;
+    return texture ? texture : m_placeholderTexture;
+}
+
+GLuint AssetManager::RequestTexture(AssetId id) {
+    // Without a budget nothing is evicted, so a resident texture needs no LRU bookkeeping
+    GLuint texture = GetTextureSlot(id).texture;
+    if (texture && m_residencyStats.budgetBytes == 0) return texture;
+    return RequestTexture(AssetRegistry::Path(id));
 }
 
 TextureData* AssetManager::GetTextureData(const std::string& path) {
@@ -96,11 +534,287 @@ GLuint AssetManager::GetGPUHandle(const std::string& path) {
     return (it != m_gpuTextures.end()) ? it->second : 0;
 }
 
+GLuint AssetManager::GetGPUHandleOrPlaceholder(const std::string& path) {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    auto it = m_gpuTextures.find(path);
+    return (it != m_gpuTextures.end()) ? it->second : m_placeholderTexture;
+}
+
 void AssetManager::FreeCPUDataForLoadedTextures() {
     std::lock_guard<std::mutex> lock(s_textureMutex);
     for (auto& [path, texture] : m_cpuTextures) {
         texture.FreeCPUData();
     }
-    std::cout << "Freed all CPU texture memory\n";
+
+    // One release for the whole batch, unless decodes still in flight are writing to it
+    size_t arenaBytes = m_pixelArena.stats().reservedBytes;
+    if (m_pixelArena.reset())
+        std::cout << "Freed all CPU texture memory (" << arenaBytes / (1024 * 1024) << " MB pixel arena)\n";
+    else
+        std::cout << "Freed CPU texture memory, pixel arena still in use\n";
+}
+
+
+int AssetManager::BuildAtlas(const AtlasSettings& settings) {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+
+    std::vector<std::pair<std::string, const TextureData*>> textures;
+    textures.reserve(m_cpuTextures.size());
+    for (auto& [path, textureData] : m_cpuTextures) {
+        textures.emplace_back(path, &textureData);
+    }
+
+    m_atlas = TextureAtlas(settings);
+    int packed = m_atlas.build(textures);
+
+    // The old regions went with the old atlas; pages are filled in by UploadAtlasToGPU
+    for (TextureSlot& slot : m_slots) {
+        slot.region = nullptr;
+        slot.atlasPage = 0;
+    }
+    for (auto& [path, region] : m_atlas.getRegions()) {
+        if (TextureSlot* slot = slotFor(path)) slot->region = &region;
+    }
+
+    std::cout << "Atlas: packed " << packed << "/" << textures.size() << " textures into "
+        << m_atlas.getPages().size() << " page(s)\n";
+    return packed;
+}
+
+void AssetManager::UploadAtlasToGPU() {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+
+    for (GLuint page : m_atlasPages) {
+        glDeleteTextures(1, &page);
+    }
+    m_atlasPages.clear();
+
+    for (auto& page : m_atlas.getPages()) {
+        GLuint textureID;
+        glGenTextures(1, &textureID);
+        glBindTexture(GL_TEXTURE_2D, textureID);
+
+        // No mipmaps: the pages are sampled with nearest filtering like the single textures
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        glTexImage2D(
+            GL_TEXTURE_2D, 0, GL_RGBA8,
+            page.width, page.height,
+            0, GL_RGBA, GL_UNSIGNED_BYTE,
+            page.pixels.data()
+        );
+
+        m_atlasPages.push_back(textureID);
+        std::cout << "Uploaded atlas page " << m_atlasPages.size() - 1 << " [ID: " << textureID << "]\n";
+    }
+
+    for (TextureSlot& slot : m_slots) {
+        slot.atlasPage = slot.region ? m_atlasPages[slot.region->page] : 0;
+    }
+
+    // UV rects as a texture buffer so shaders can look a region up by index
+    std::vector<float> rects;
+    rects.reserve(m_atlas.getRegionList().size() * 4);
+    for (auto& region : m_atlas.getRegionList()) {
+        rects.insert(rects.end(), { region.u0, region.v0, region.u1, region.v1 });
+    }
+
+    if (m_atlasRegionVBO == 0) glGenBuffers(1, &m_atlasRegionVBO);
+    if (m_atlasRegionTexture == 0) glGenTextures(1, &m_atlasRegionTexture);
+
+    glBindBuffer(GL_TEXTURE_BUFFER, m_atlasRegionVBO);
+    glBufferData(GL_TEXTURE_BUFFER, rects.size() * sizeof(float), rects.data(), GL_STATIC_DRAW);
+    glBindTexture(GL_TEXTURE_BUFFER, m_atlasRegionTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_atlasRegionVBO);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+const AtlasRegion* AssetManager::GetAtlasRegion(const std::string& path) {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    return m_atlas.find(path);
+}
+
+GLuint AssetManager::GetAtlasRegionBuffer() {
+    return m_atlasRegionTexture;
+}
+
+GLuint AssetManager::GetAtlasPageHandle(int page) {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    return (page >= 0 && page < static_cast<int>(m_atlasPages.size())) ? m_atlasPages[page] : 0;
+}
+
+int AssetManager::UploadTextureArrayToGPU() {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+
+    if (m_textureArray) glDeleteTextures(1, &m_textureArray);
+    m_textureArray = 0;
+    m_textureArrayLayers.clear();
+    for (TextureSlot& slot : m_slots) slot.arrayLayer = -1;
+
+    // Every layer of an array has the same size, so only the most common size goes in
+    std::map<std::pair<int, int>, std::vector<std::string>> bySize;
+    for (auto& [path, textureData] : m_cpuTextures) {
+        if (!textureData.RGBA()) continue;
+        bySize[{ textureData.width, textureData.height }].push_back(path);
+    }
+
+    std::vector<std::string>* paths = nullptr;
+    std::pair<int, int> size;
+    for (auto& [key, group] : bySize) {
+        if (!paths || group.size() > paths->size()) {
+            paths = &group;
+            size = key;
+        }
+    }
+    if (!paths || paths->size() < 2) {
+        std::cout << "Texture array: no shared texture size, skipping\n";
+        return 0;
+    }
+
+    GLint maxLayers = 0;
+    glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+
+    // Sorted so a texture always gets the same layer for the same asset folder
+    std::sort(paths->begin(), paths->end());
+    if (static_cast<GLint>(paths->size()) > maxLayers) {
+        std::cerr << "Texture array: " << paths->size() << " textures exceed GL_MAX_ARRAY_TEXTURE_LAYERS ("
+            << maxLayers << "), the rest use single textures\n";
+        paths->resize(maxLayers);
+    }
+
+    glGenTextures(1, &m_textureArray);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, m_textureArray);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, size.first, size.second,
+        static_cast<GLsizei>(paths->size()), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    for (size_t layer = 0; layer < paths->size(); layer++) {
+        const TextureData& textureData = m_cpuTextures[(*paths)[layer]];
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, static_cast<GLint>(layer),
+            size.first, size.second, 1, GL_RGBA, GL_UNSIGNED_BYTE, textureData.RGBA());
+        m_textureArrayLayers[(*paths)[layer]] = static_cast<int>(layer);
+        if (TextureSlot* slot = slotFor((*paths)[layer])) slot->arrayLayer = static_cast<int>(layer);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+    std::cout << "Texture array: " << paths->size() << " layers of " << size.first << "x" << size.second
+        << ", " << (m_cpuTextures.size() - paths->size()) << " texture(s) fall back [ID: " << m_textureArray << "]\n";
+    return static_cast<int>(paths->size());
+}
+
+int AssetManager::GetTextureArrayLayer(const std::string& path) {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    auto it = m_textureArrayLayers.find(path);
+    return (it != m_textureArrayLayers.end()) ? it->second : -1;
+}
+
+GLuint AssetManager::GetTextureArrayHandle() {
+    return m_textureArray;
+}
+
+size_t AssetManager::BuildThumbnailAtlas(const std::vector<AssetId>& assets) {
+    Init();
+    uint64_t generation = ++m_thumbnailGeneration; // Thumbnails of an earlier build are dropped
+    {
+        std::lock_guard<std::mutex> lock(s_textureMutex);
+        for (TextureSlot& slot : m_slots) slot.thumbnailCell = -1;
+    }
+
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    size_t count = m_thumbnailAtlas.layout(assets.size(), std::min<GLint>(maxSize, kMaxThumbnailAtlasSize));
+    int size = m_thumbnailAtlas.size();
+
+    if (!m_thumbnailTexture) glGenTextures(1, &m_thumbnailTexture);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindTexture(GL_TEXTURE_2D, m_thumbnailTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    // Cells are only sampled once written, so the rest can stay undefined
+    int x, y;
+    m_thumbnailAtlas.cellOrigin(ThumbnailAtlas::kWhiteCell, x, y);
+    std::vector<unsigned char> white = ThumbnailAtlas::WhiteCell();
+    glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, ThumbnailAtlas::kCellSize, ThumbnailAtlas::kCellSize,
+        GL_RGBA, GL_UNSIGNED_BYTE, white.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_pendingThumbnails.store(static_cast<int>(count), std::memory_order_relaxed);
+
+    // Batches keep the pool's queue short for big libraries; texture decodes queued earlier go first
+    const size_t kThumbnailsPerJob = 64;
+    for (size_t first = 0; first < count; first += kThumbnailsPerJob) {
+        std::vector<std::pair<AssetId, int>> batch;
+        for (size_t i = first; i < std::min(count, first + kThumbnailsPerJob); i++)
+            batch.emplace_back(assets[i], static_cast<int>(i) + 1); // Cell 0 is the white one
+
+        // Runs on a decode thread: reads the pack (not reopened while the editor runs) and
+        // the registry's stable entries, nothing else shared
+        m_decodePool->submit([batch = std::move(batch), generation]() {
+            PROFILE_SCOPE("Make thumbnails");
+            for (auto& [asset, cell] : batch) {
+                const std::string& path = AssetRegistry::Path(asset);
+                TextureData source;
+                if (const AssetPack::Entry* entry = m_pack.find(path))
+                    m_pack.textureView(*entry, source);
+                else
+                    source.LoadFromFile(path); // A failed load gives an empty cell, still pushed to count it off
+                m_completedThumbnails.push({ generation, asset, cell, ThumbnailAtlas::MakeThumbnail(source) });
+            }
+        });
+    }
+
+    std::cout << "Thumbnail atlas: " << count << "/" << assets.size() << " thumbnails in " << size << "x" << size
+        << " [ID: " << m_thumbnailTexture << "]\n";
+    if (count < assets.size())
+        std::cerr << "Thumbnail atlas: full, " << assets.size() - count << " asset(s) use their own texture in the palette\n";
+    return count;
+}
+
+int AssetManager::UploadPendingThumbnails() {
+    std::lock_guard<std::mutex> lock(s_textureMutex);
+    bool bound = false;
+    int uploaded = 0;
+    m_completedThumbnails.drain([&](Thumbnail& thumbnail) {
+        if (thumbnail.generation != m_thumbnailGeneration || !m_thumbnailTexture) return;
+        m_pendingThumbnails.fetch_sub(1, std::memory_order_relaxed);
+        if (!bound) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            glBindTexture(GL_TEXTURE_2D, m_thumbnailTexture);
+            bound = true;
+        }
+
+        int x, y;
+        m_thumbnailAtlas.cellOrigin(thumbnail.cell, x, y);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, ThumbnailAtlas::kCellSize, ThumbnailAtlas::kCellSize,
+            GL_RGBA, GL_UNSIGNED_BYTE, thumbnail.pixels.data());
+        slotFor(thumbnail.asset).thumbnailCell = thumbnail.cell;
+        uploaded++;
+    });
+    if (bound) glBindTexture(GL_TEXTURE_2D, 0);
+    return uploaded;
+}
+
+int AssetManager::PendingThumbnails() {
+    return m_pendingThumbnails.load(std::memory_order_relaxed);
 }
 
+GLuint AssetManager::GetThumbnailAtlasHandle() {
+    return m_thumbnailTexture;
+}
+
+ThumbnailUV AssetManager::GetThumbnailUV(int cell) {
+    return m_thumbnailAtlas.uv(cell);
+}
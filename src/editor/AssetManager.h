@@ -1,26 +1,191 @@
 #pragma once
 
 #include "TextureData.h"
+#include "TextureAtlas.h"
+#include "ThumbnailAtlas.h"
+#include "WorkerPool.h"
+#include "CompletionQueue.h"
+#include "StreamBuffer.h"
+#include "AssetPack.h"
+#include "AssetRegistry.h"
 #include <glad/glad.h>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
+#include <deque>
+#include <list>
 #include <string>
-#include <future>
+#include <memory>
+#include <atomic>
 
 class AssetManager {
 public:
 
-    static void Init();
+    /**
+     * Init: Starts the decode pool. decodeThreads 0 means one per core, minus the main thread.
+     */
+    static void Init(unsigned int decodeThreads = 0);
     static void Shutdown();
-    static std::future<TextureData*> LoadTextureAsync(const std::string& path);
+
+    // Texture loading: LoadTextureAsync() queues the decode (and compression, see below) on
+    // the decode pool, where nothing is locked while a file decodes. Finished textures come
+    // back through a lock-free queue and only show up in GetTextureData() once the main
+    // thread drains it with ProcessCompletedLoads() or WaitForTextureLoads().
+    static void LoadTextureAsync(const std::string& path); // Main thread; repeated paths are ignored
+    static int ProcessCompletedLoads();                     // Returns how many loads finished
+    static void WaitForTextureLoads();                      // Drains until nothing is in flight
+    static int PendingTextureLoads();                       // Queued or decoding
+    static unsigned int DecodeThreadCount();
+
+    // Asset pack: OpenAssetPack() brings the pack at `packPath` up to date with `sources`
+    // (only changed files are baked again, see AssetPack::Update) and maps it. After that,
+    // LoadTextureAsync() serves textures found in the pack straight from the mapping: no
+    // decode, and the upload reads the baked mip chain (or compressed level) in place, not
+    // through the staging buffer. Call before loading any texture.
+    static bool OpenAssetPack(const std::string& packPath, const std::vector<std::string>& sources);
+    static bool HasAssetPack();
+
     static void UploadAllTexturesToGPU();
+
+    // Progressive upload: textures that finished loading wait in an upload queue and go to
+    // the GPU through a pixel unpack StreamBuffer, a few per frame so no frame stalls on a
+    // burst of them. Stops once `maxBytes` or `maxMs` is reached (0 = no limit), but always
+    // uploads at least one texture. Main thread; returns how many were uploaded.
+    static constexpr size_t kUploadRegionBytes = 4 * 1024 * 1024; // Larger textures upload directly
+    static int UploadPendingTextures(size_t maxBytes, double maxMs);
+    static int PendingTextureUploads();
+
+    // Residency: with a budget set, textures load the first time RequestTexture() asks for
+    // them, and once the resident textures exceed the budget the least recently requested
+    // ones are evicted (GPU texture and CPU entry). Textures requested since the last
+    // UpdateResidency() are never evicted, so a frame that needs more than the budget goes
+    // over it instead of thrashing. CPU copies are dropped on upload while a budget is set.
+    // 0 = no budget: nothing is evicted and CPU copies stay until FreeCPUData.
+    struct ResidencyStats {
+        int hits = 0;           // RequestTexture() found the texture on the GPU
+        int misses = 0;         // ... had to queue a load for it
+        int evictions = 0;
+        int resident = 0;
+        size_t residentBytes = 0; // Estimated VRAM of the resident textures
+        size_t budgetBytes = 0;
+    };
+    static void SetResidencyBudget(size_t bytes);
+    static GLuint RequestTexture(const std::string& path); // Main thread; placeholder until resident
+    static void UpdateResidency();                          // Once per frame, evicts over budget
+    static const ResidencyStats& GetResidencyStats();
+
+    // Per-asset draw state indexed by AssetId, kept in step with the path-keyed calls above
+    // and below for every path AssetRegistry knows. Main thread only and lock-free, for the
+    // per-frame draw loops; worker threads use the path-keyed calls.
+    struct TextureSlot {
+        GLuint texture = 0;                  // Own GL texture, 0 until resident
+        GLuint atlasPage = 0;                // 0 until the atlas is uploaded
+        const AtlasRegion* region = nullptr; // In the atlas, if packed
+        int arrayLayer = -1;                 // In the texture array, -1 if not there
+        int thumbnailCell = -1;              // In the thumbnail atlas, -1 until uploaded
+    };
+    static const TextureSlot& GetTextureSlot(AssetId id);
+    static GLuint GetGPUHandleOrPlaceholder(AssetId id);
+    static GLuint RequestTexture(AssetId id); // Slot lookup only, unless a residency budget is set
+
     static TextureData* GetTextureData(const std::string& path);
     static GLuint GetGPUHandle(const std::string& path);
+    // Like GetGPUHandle, but a neutral checker while the texture isn't resident (yet)
+    static GLuint GetGPUHandleOrPlaceholder(const std::string& path);
     static void FreeCPUDataForLoadedTextures();
 
+    // Block compression: textures of at least kCompressMinPixels are encoded to BC1/BC3 at
+    // load time (cached next to the source) and uploaded compressed if the driver supports
+    // it, RGBA8 otherwise. Set before loading.
+    static constexpr int kCompressMinPixels = 256 * 256;
+    static void SetTextureCompression(bool enabled);
+    static bool IsCompressedFormatSupported(BlockFormat format);
+    static size_t GetGPUTextureBytes(); // Estimated VRAM of the per-texture uploads
+
+    // Atlas: packs the loaded CPU textures into shared pages (call before FreeCPUData)
+    static int BuildAtlas(const AtlasSettings& settings = {});
+    static void UploadAtlasToGPU();
+    static const AtlasRegion* GetAtlasRegion(const std::string& path);
+    static GLuint GetAtlasPageHandle(int page);
+    static GLuint GetAtlasRegionBuffer(); // samplerBuffer of uv rects, indexed by AtlasRegion::index
+
+    // Texture array: the most common texture size goes into one GL_TEXTURE_2D_ARRAY, one
+    // layer per texture (call before FreeCPUData). Other sizes stay on the per-texture path.
+    static int UploadTextureArrayToGPU();
+    static int GetTextureArrayLayer(const std::string& path); // -1 if the texture isn't in the array
+    static GLuint GetTextureArrayHandle();
+
+    /**
+     * Thumbnails: every palette asset downscaled into one texture, so the palette is a
+     * single draw. BuildThumbnailAtlas (main thread, after OpenAssetPack) lays it out and
+     * makes the thumbnails on the decode pool, from the pack's mips when the asset is baked
+     * and by decoding the PNG otherwise; nothing waits for the full textures.
+     * UploadPendingThumbnails copies the finished ones in, once per frame.
+     */
+    static constexpr int kMaxThumbnailAtlasSize = 4096; // Assets past its capacity get no thumbnail
+    static size_t BuildThumbnailAtlas(const std::vector<AssetId>& assets);
+    static int UploadPendingThumbnails();
+    static int PendingThumbnails(); // Asked for and not uploaded yet
+    static GLuint GetThumbnailAtlasHandle();
+    static ThumbnailUV GetThumbnailUV(int cell); // Cell from TextureSlot, or ThumbnailAtlas::kWhiteCell
+
 private:
+    struct DecodedTexture {
+        std::string path;
+        TextureData texture;
+        bool loaded = false;
+    };
+
+    struct Thumbnail {
+        uint64_t generation = 0; // Of the build that asked for it; older ones are dropped
+        AssetId asset = kNoAsset;
+        int cell = -1;
+        std::vector<unsigned char> pixels;
+    };
+
+    struct ResidentTexture {
+        uint64_t lastUsedFrame = 0;
+        size_t bytes = 0;
+        std::list<std::string>::iterator lruPosition;
+    };
+
+    static GLuint createGPUTexture(const TextureData& textureData, const void* source);
+    static void makeResident(const std::string& path, TextureData& textureData, GLuint textureID);
+    static void evict(const std::string& path);
+    static void ensurePlaceholder();
+    static TextureSlot* slotFor(const std::string& path); // nullptr for paths the registry doesn't know
+    static TextureSlot& slotFor(AssetId id);
+
     static std::unordered_map<std::string, TextureData> m_cpuTextures;
     static std::unordered_map<std::string, GLuint> m_gpuTextures;
-    static std::vector<std::future<void>> m_loadingFutures;
+    static std::vector<TextureSlot> m_slots; // By AssetId
+    static std::deque<std::string> m_uploadQueue;          // Loaded, not on the GPU yet
+    static std::unique_ptr<StreamBuffer> m_uploadBuffer;  // Created on first progressive upload
+    static GLuint m_placeholderTexture;
+    static std::unique_ptr<WorkerPool> m_decodePool;
+    static CompletionQueue<DecodedTexture> m_completedLoads;
+    static std::atomic<int> m_pendingLoads;
+    static std::unordered_set<std::string> m_requestedTextures; // Main thread only
+    static std::unordered_set<std::string> m_failedTextures;    // Main thread only; not retried until Shutdown
+    static AssetPack m_pack; // Outlives every TextureData that points into it
+    static PixelArena m_pixelArena; // Decoded pixels of the textures loaded outside a budget
+    static TextureAtlas m_atlas;
+    static std::vector<GLuint> m_atlasPages;
+    static GLuint m_atlasRegionVBO;
+    static GLuint m_atlasRegionTexture;
+    static GLuint m_textureArray;
+    static std::unordered_map<std::string, int> m_textureArrayLayers;
+    static ThumbnailAtlas m_thumbnailAtlas;
+    static GLuint m_thumbnailTexture;
+    static CompletionQueue<Thumbnail> m_completedThumbnails;
+    static uint64_t m_thumbnailGeneration;
+    static std::atomic<int> m_pendingThumbnails;
+    static bool m_compressTextures;
+    static size_t m_gpuTextureBytes;
+
+    static std::unordered_map<std::string, ResidentTexture> m_residency;
+    static std::list<std::string> m_lru; // Most recently requested first
+    static ResidencyStats m_residencyStats;
+    static uint64_t m_residencyFrame;
 };
 
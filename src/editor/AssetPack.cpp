@@ -0,0 +1,382 @@
+#include "AssetPack.h"
+#include "WorkerPool.h"
+#include "Hash.h"
+#include "Profiler.h"
+#include "ImageKernels.h"
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+namespace {
+    constexpr uint64_t kBlobAlignment = 16;
+
+    static_assert(sizeof(AssetPack::Header) == 56, "AssetPack::Header layout is part of the file format");
+    static_assert(sizeof(AssetPack::Entry) == 80, "AssetPack::Entry layout is part of the file format");
+    static_assert(sizeof(AssetPack::Failed) == 24, "AssetPack::Failed layout is part of the file format");
+
+    int mipLevelCount(int width, int height) {
+        int levels = 1;
+        while (width > 1 || height > 1) {
+            width = ImageKernels::NextMipSize(width);
+            height = ImageKernels::NextMipSize(height);
+            levels++;
+        }
+        return levels;
+    }
+
+    uint64_t mipChainBytes(int width, int height) {
+        uint64_t bytes = 0;
+        for (;;) {
+            bytes += static_cast<uint64_t>(width) * height * 4;
+            if (width == 1 && height == 1) return bytes;
+            width = ImageKernels::NextMipSize(width);
+            height = ImageKernels::NextMipSize(height);
+        }
+    }
+
+    // A source as Update() sees it: stat info, and what to write for it
+    struct PackSource {
+        std::string name;
+        uint64_t size = 0;
+        int64_t time = 0;
+        uint64_t hash = 0;
+        const AssetPack::Entry* reuse = nullptr; // Old entry whose blobs still match
+        bool statChanged = false;                // Reused, but the stored size/time are stale
+        bool ok = true;
+        bool failedBefore = false;               // Not decoded: it failed last time and hasn't changed
+
+        TextureData texture; // Rebuilt sources only, with its mips
+    };
+
+    void bake(PackSource& source, int compressMinPixels) {
+        PROFILE_SCOPE("Bake texture");
+
+        if (!source.texture.LoadFromFile(source.name)) {
+            source.ok = false;
+            return;
+        }
+        source.hash = source.texture.sourceHash;
+        TextureLoader::GenerateMipmapsCPU(source.texture);
+
+        if (compressMinPixels > 0 && source.texture.width * source.texture.height >= compressMinPixels)
+            source.texture.LoadOrBuildCompressed();
+    }
+
+    bool readFile(const std::string& path, std::vector<unsigned char>& bytes) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) return false;
+        bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        return true;
+    }
+}
+
+bool AssetPack::open(const std::string& path) {
+    close();
+    if (!m_file.open(path)) return false;
+
+    const unsigned char* data = m_file.data();
+    const uint64_t size = m_file.size();
+    auto fail = [&](const char* reason) {
+        std::cerr << "AssetPack: ignoring " << path << " (" << reason << ")\n";
+        close();
+        return false;
+    };
+
+    if (size < sizeof(Header)) return fail("truncated");
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if (header->magic != kMagic) return fail("not a pack");
+    if (header->version != kVersion) return fail("old version");
+    if (header->indexOffset % alignof(Entry) != 0 ||
+        header->indexOffset > size || header->entryCount > (size - header->indexOffset) / sizeof(Entry))
+        return fail("bad index");
+    if (header->namesOffset > size || header->namesBytes > size - header->namesOffset)
+        return fail("bad name table");
+    if (header->failedOffset % alignof(Failed) != 0 ||
+        header->failedOffset > size || header->failedCount > (size - header->failedOffset) / sizeof(Failed))
+        return fail("bad failed list");
+
+    auto inFile = [size](uint64_t offset, uint64_t bytes) { return offset <= size && bytes <= size - offset; };
+
+    m_header = header;
+    m_entries = reinterpret_cast<const Entry*>(data + header->indexOffset);
+    m_names = reinterpret_cast<const char*>(data + header->namesOffset);
+    m_failed = reinterpret_cast<const Failed*>(data + header->failedOffset);
+    m_index.reserve(header->entryCount);
+
+    for (uint32_t i = 0; i < header->entryCount; i++) {
+        const Entry& entry = m_entries[i];
+        BlockFormat format = static_cast<BlockFormat>(entry.compressedFormat);
+        bool valid =
+            entry.width > 0 && entry.height > 0 &&
+            static_cast<uint64_t>(entry.nameOffset) + entry.nameLength <= header->namesBytes &&
+            entry.levels == static_cast<uint32_t>(mipLevelCount(entry.width, entry.height)) &&
+            entry.dataBytes == mipChainBytes(entry.width, entry.height) &&
+            inFile(entry.dataOffset, entry.dataBytes) &&
+            (format == BlockFormat::None ? entry.compressedBytes == 0 :
+                entry.compressedBytes == BlockCompressor::EncodedSize(entry.width, entry.height, format) &&
+                inFile(entry.compressedOffset, entry.compressedBytes));
+        if (!valid) return fail("bad entry");
+        m_index.emplace(name(entry), i);
+    }
+    for (uint32_t i = 0; i < header->failedCount; i++) {
+        if (static_cast<uint64_t>(m_failed[i].nameOffset) + m_failed[i].nameLength > header->namesBytes)
+            return fail("bad failed entry");
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    m_index.clear();
+    m_header = nullptr;
+    m_entries = nullptr;
+    m_failed = nullptr;
+    m_names = nullptr;
+    m_file.close();
+}
+
+const AssetPack::Entry* AssetPack::find(std::string_view name) const {
+    auto it = m_index.find(name);
+    return it != m_index.end() ? &m_entries[it->second] : nullptr;
+}
+
+std::string_view AssetPack::name(const Entry& entry) const {
+    return std::string_view(m_names + entry.nameOffset, entry.nameLength);
+}
+
+bool AssetPack::failedBefore(std::string_view name, uint64_t size, int64_t time) const {
+    // A scan: broken sources are few, and only looked for when a source isn't in the index
+    for (uint32_t i = 0; m_header && i < m_header->failedCount; i++) {
+        const Failed& failed = m_failed[i];
+        if (failed.sourceSize == size && failed.sourceTime == time &&
+            std::string_view(m_names + failed.nameOffset, failed.nameLength) == name)
+            return true;
+    }
+    return false;
+}
+
+void AssetPack::textureView(const Entry& entry, TextureData& out) const {
+    out.width = entry.width;
+    out.height = entry.height;
+    out.channels = 4;
+    out.filepath = std::string(name(entry));
+    out.sourceHash = entry.sourceHash;
+
+    out.mappedLevels.clear();
+    out.mappedLevels.reserve(entry.levels);
+    const unsigned char* level = m_file.data() + entry.dataOffset;
+    int width = entry.width;
+    int height = entry.height;
+    for (uint32_t i = 0; i < entry.levels; i++) {
+        out.mappedLevels.push_back({ level, width, height });
+        level += static_cast<size_t>(width) * height * 4;
+        width = ImageKernels::NextMipSize(width);
+        height = ImageKernels::NextMipSize(height);
+    }
+
+    out.compressedFormat = static_cast<BlockFormat>(entry.compressedFormat);
+    out.mappedCompressed = entry.compressedBytes ? m_file.data() + entry.compressedOffset : nullptr;
+    out.mappedCompressedBytes = static_cast<size_t>(entry.compressedBytes);
+}
+
+bool AssetPack::Update(const std::string& packPath, const std::vector<std::string>& sources,
+    int compressMinPixels, UpdateStats* stats) {
+    PROFILE_SCOPE("AssetPack::Update");
+    namespace fs = std::filesystem;
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    UpdateStats result;
+
+    // Blobs baked with another compression threshold can't be reused
+    AssetPack old;
+    if (old.open(packPath) && old.m_header->compressMinPixels != compressMinPixels)
+        old.close();
+
+    std::vector<std::unique_ptr<PackSource>> entries;
+    entries.reserve(sources.size());
+    result.removed = static_cast<int>(old.entryCount()); // Minus every source found in it
+    {
+        // Stat on this thread; only sources that changed go to the pool, and the pool's
+        // destructor waits for them before anything is written
+        WorkerPool pool;
+        for (const std::string& path : sources) {
+            auto source = std::make_unique<PackSource>();
+            source->name = path;
+
+            std::error_code error;
+            source->size = fs::file_size(path, error);
+            if (!error) source->time = fs::last_write_time(path, error).time_since_epoch().count();
+            if (error) {
+                std::cerr << "AssetPack: can't read " << path << "\n";
+                result.failed++;
+                continue;
+            }
+
+            const Entry* previous = old.find(path);
+            if (previous) result.removed--;
+            if (!previous && old.failedBefore(path, source->size, source->time)) {
+                source->ok = false;
+                source->failedBefore = true;
+                entries.push_back(std::move(source));
+                continue;
+            }
+            if (previous && previous->sourceSize == source->size && previous->sourceTime == source->time) {
+                source->reuse = previous;
+                source->hash = previous->sourceHash;
+                entries.push_back(std::move(source));
+                continue;
+            }
+
+            PackSource* job = source.get();
+            entries.push_back(std::move(source));
+            pool.submit([job, previous, compressMinPixels]() {
+                // Touched but not edited: the bytes still hash the same
+                std::vector<unsigned char> bytes;
+                if (previous && readFile(job->name, bytes) &&
+                    Fnv1a64(bytes.data(), bytes.size()) == previous->sourceHash) {
+                    job->reuse = previous;
+                    job->hash = previous->sourceHash;
+                    job->statChanged = true;
+                    return;
+                }
+                bake(*job, compressMinPixels);
+            });
+        }
+    }
+
+    bool changed = result.removed > 0;
+    for (auto& source : entries) {
+        if (!source->ok) {
+            std::cerr << "AssetPack: can't decode " << source->name
+                << (source->failedBefore ? " (unchanged since it last failed)" : "") << "\n";
+            result.failed++;
+            // A new failure is written once, dropping its old entry if it had one; after that
+            // the unchanged file is neither decoded nor a reason to rewrite the pack
+            changed |= !source->failedBefore;
+        }
+        else if (source->reuse) {
+            result.reused++;
+            changed |= source->statChanged;
+        }
+        else {
+            result.rebuilt++;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        std::string tmpPath = packPath + ".tmp";
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+
+        uint64_t offset = 0;
+        auto write = [&](const void* data, uint64_t bytes) {
+            out.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+            offset += bytes;
+        };
+        auto align = [&](uint64_t alignment) {
+            static const char zeros[kBlobAlignment] = {};
+            write(zeros, (alignment - offset % alignment) % alignment);
+        };
+
+        Header header{};
+        write(&header, sizeof(header)); // Filled in once the offsets are known
+
+        std::vector<Entry> index;
+        std::string names;
+        for (auto& source : entries) {
+            if (!source->ok) continue;
+
+            Entry entry{};
+            entry.sourceHash = source->hash;
+            entry.sourceSize = source->size;
+            entry.sourceTime = source->time;
+            entry.nameOffset = static_cast<uint32_t>(names.size());
+            entry.nameLength = static_cast<uint32_t>(source->name.size());
+            names += source->name;
+
+            if (const Entry* reuse = source->reuse) {
+                entry.width = reuse->width;
+                entry.height = reuse->height;
+                entry.levels = reuse->levels;
+                entry.compressedFormat = reuse->compressedFormat;
+
+                align(kBlobAlignment);
+                entry.dataOffset = offset;
+                entry.dataBytes = reuse->dataBytes;
+                write(old.m_file.data() + reuse->dataOffset, reuse->dataBytes);
+                if (reuse->compressedBytes) {
+                    align(kBlobAlignment);
+                    entry.compressedOffset = offset;
+                    entry.compressedBytes = reuse->compressedBytes;
+                    write(old.m_file.data() + reuse->compressedOffset, reuse->compressedBytes);
+                }
+            }
+            else {
+                const TextureData& texture = source->texture;
+                entry.width = texture.width;
+                entry.height = texture.height;
+                entry.levels = static_cast<uint32_t>(texture.mips.size() + 1);
+                entry.compressedFormat = static_cast<uint32_t>(texture.compressedFormat);
+
+                align(kBlobAlignment);
+                entry.dataOffset = offset;
+                write(texture.pixels.data(), texture.pixels.size());
+                for (auto& mip : texture.mips) write(mip.data(), mip.size());
+                entry.dataBytes = offset - entry.dataOffset;
+                if (!texture.compressed.empty()) {
+                    align(kBlobAlignment);
+                    entry.compressedOffset = offset;
+                    entry.compressedBytes = texture.compressed.size();
+                    write(texture.compressed.data(), texture.compressed.size());
+                }
+            }
+            index.push_back(entry);
+        }
+
+        std::vector<Failed> failedList;
+        for (auto& source : entries) {
+            if (source->ok) continue;
+            failedList.push_back({ source->size, source->time, static_cast<uint32_t>(names.size()),
+                static_cast<uint32_t>(source->name.size()) });
+            names += source->name;
+        }
+
+        align(alignof(Entry));
+        header = { kMagic, kVersion, static_cast<uint32_t>(index.size()), compressMinPixels, offset, 0, names.size(),
+            0, static_cast<uint32_t>(failedList.size()), 0 };
+        write(index.data(), index.size() * sizeof(Entry));
+        align(alignof(Failed));
+        header.failedOffset = offset;
+        write(failedList.data(), failedList.size() * sizeof(Failed));
+        header.namesOffset = offset;
+        write(names.data(), names.size());
+
+        out.seekp(0);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.close();
+
+        old.close(); // Unmapped before the file underneath is replaced
+        std::error_code error;
+        if (!out) {
+            std::cerr << "AssetPack: could not write " << tmpPath << "\n";
+            fs::remove(tmpPath, error);
+            return false;
+        }
+        fs::rename(tmpPath, packPath, error);
+        if (error) {
+            std::cerr << "AssetPack: could not replace " << packPath << " (" << error.message() << ")\n";
+            fs::remove(tmpPath, error);
+            return false;
+        }
+        result.written = true;
+    }
+
+    result.ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    std::cout << "Asset pack " << packPath << ": " << result.reused << " reused, " << result.rebuilt << " rebuilt, "
+        << result.removed << " removed" << (result.written ? "" : " (up to date)") << " in " << result.ms << " ms\n";
+    if (stats) *stats = result;
+    return true;
+}
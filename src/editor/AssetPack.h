@@ -0,0 +1,118 @@
+#pragma once
+#include "MappedFile.h"
+#include "TextureData.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+/**
+ * AssetPack: Every texture of the asset folder baked into one file, so startup maps a
+ * single file instead of opening and decoding hundreds of PNGs. Layout:
+ *
+ *   Header | pixel blobs (16-byte aligned) | Entry index | Failed list | name table
+ *
+ * Each entry holds the RGBA8 mip chain (already flipped to GL's bottom-row-first order)
+ * and, for large textures, a block-compressed level 0. Sources that couldn't be decoded
+ * are listed with their size and write time, so they aren't tried again until they change. The pack is opened with MappedFile
+ * and textures point straight into the mapping, so uploads read the pages the OS mapped
+ * in without an intermediate copy.
+ */
+class AssetPack {
+public:
+    static constexpr uint32_t kMagic = 0x50443254;  // "T2DP"
+    static constexpr uint32_t kVersion = 2;          // Bump when the layout or the baking changes
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        int32_t compressMinPixels; // Textures this large carry a BC level; 0 = none do
+        uint64_t indexOffset;      // Entry[entryCount]
+        uint64_t namesOffset;
+        uint64_t namesBytes;
+        uint64_t failedOffset;     // Failed[failedCount]
+        uint32_t failedCount;
+        uint32_t reserved;
+    };
+
+    struct Entry {
+        uint64_t sourceHash;       // FNV-1a of the source file's bytes
+        uint64_t sourceSize;       // Size and write time let an unchanged source skip hashing
+        int64_t sourceTime;
+        uint32_t nameOffset;       // Into the name table, not null-terminated
+        uint32_t nameLength;
+        int32_t width;
+        int32_t height;
+        uint32_t levels;           // RGBA8 mip levels, down to 1x1
+        uint32_t compressedFormat; // BlockFormat, None if there is no compressed level
+        uint64_t dataOffset;       // The RGBA8 levels back to back, level 0 first
+        uint64_t dataBytes;
+        uint64_t compressedOffset;
+        uint64_t compressedBytes;
+    };
+
+    // A source that couldn't be decoded when the pack was written
+    struct Failed {
+        uint64_t sourceSize;
+        int64_t sourceTime;
+        uint32_t nameOffset;       // Into the name table, like Entry's
+        uint32_t nameLength;
+    };
+
+    struct UpdateStats {
+        int reused = 0;       // Taken over from the old pack
+        int rebuilt = 0;      // Decoded (and compressed) again
+        int removed = 0;      // In the old pack but no longer a source
+        int failed = 0;       // Couldn't be read or decoded (now or, unchanged, last time), left out
+        bool written = false; // False when the pack was already up to date
+        double ms = 0.0;
+    };
+
+    AssetPack() = default;
+    ~AssetPack() = default;
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    // Maps the pack and checks its index. False (and closed) if it's missing or malformed.
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return m_header != nullptr; }
+
+    const Entry* find(std::string_view name) const;
+    std::string_view name(const Entry& entry) const;
+    uint32_t entryCount() const { return m_header ? m_header->entryCount : 0; }
+    const Entry& entry(uint32_t index) const { return m_entries[index]; }
+    size_t fileBytes() const { return m_file.size(); }
+
+    /**
+     * Texture view: Fills `out` with views into the mapping (mappedLevels, mappedCompressed),
+     * no pixels are copied. They stay valid until the pack is closed.
+     */
+    void textureView(const Entry& entry, TextureData& out) const;
+
+    /**
+     * Update: Brings the pack at `packPath` in line with `sources`. Entries whose source kept
+     * its size and write time are copied over as they are, ones whose bytes still hash the
+     * same are too; only the rest are decoded again, on a worker pool, except the ones that
+     * already failed to decode with the same size and write time. Sources that are gone are
+     * dropped. Nothing is written if nothing changed, otherwise the new pack goes
+     * to <packPath>.tmp and replaces the old one, so close every open AssetPack on that
+     * path first.
+     */
+    static bool Update(const std::string& packPath, const std::vector<std::string>& sources,
+        int compressMinPixels, UpdateStats* stats = nullptr);
+
+private:
+    // True if `name` failed to decode last time and still has the size and write time it had then
+    bool failedBefore(std::string_view name, uint64_t size, int64_t time) const;
+
+    MappedFile m_file;
+    const Header* m_header = nullptr;
+    const Entry* m_entries = nullptr;
+    const Failed* m_failed = nullptr;
+    const char* m_names = nullptr;
+    std::unordered_map<std::string_view, uint32_t> m_index;
+};
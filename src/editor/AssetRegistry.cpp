@@ -0,0 +1,79 @@
+#include "AssetRegistry.h"
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <iostream>
+
+namespace {
+    struct AssetEntry {
+        std::string name;
+        std::string path;
+    };
+
+    // Blocks are allocated as ids run out and never move, so a reader on another thread can
+    // hold on to an entry while the main thread interns more
+    constexpr size_t kBlockSize = 1024;
+    constexpr size_t kMaxBlocks = 4096;
+    std::unique_ptr<AssetEntry[]> s_blocks[kMaxBlocks];
+    std::atomic<size_t> s_count{ 0 };
+
+    // Keys view the entries' own strings
+    std::unordered_map<std::string_view, AssetId> s_byName;
+    std::unordered_map<std::string_view, AssetId> s_byPath;
+
+    const AssetEntry s_none;
+
+    AssetId append(std::string_view name) {
+        size_t id = s_count.load(std::memory_order_relaxed);
+        if (id >= kBlockSize * kMaxBlocks) {
+            std::cerr << "AssetRegistry: out of ids, " << name << " maps to the empty asset\n";
+            return kNoAsset;
+        }
+
+        std::unique_ptr<AssetEntry[]>& block = s_blocks[id / kBlockSize];
+        if (!block) block = std::make_unique<AssetEntry[]>(kBlockSize);
+
+        AssetEntry& entry = block[id % kBlockSize];
+        entry.name = std::string(name);
+        entry.path = name.empty() ? std::string() : AssetRegistry::kAssetFolder + entry.name + ".png";
+        s_byName.emplace(entry.name, static_cast<AssetId>(id));
+        s_byPath.emplace(entry.path, static_cast<AssetId>(id));
+
+        s_count.store(id + 1, std::memory_order_release);
+        return static_cast<AssetId>(id);
+    }
+
+    const AssetEntry& entryFor(AssetId id) {
+        if (id >= s_count.load(std::memory_order_acquire)) return s_none;
+        return s_blocks[id / kBlockSize][id % kBlockSize];
+    }
+}
+
+AssetId AssetRegistry::Intern(std::string_view name) {
+    if (s_count.load(std::memory_order_relaxed) == 0) append(""); // kNoAsset
+
+    auto it = s_byName.find(name);
+    return it != s_byName.end() ? it->second : append(name);
+}
+
+AssetId AssetRegistry::Find(std::string_view name) {
+    auto it = s_byName.find(name);
+    return it != s_byName.end() ? it->second : kNoAsset;
+}
+
+AssetId AssetRegistry::FindPath(std::string_view path) {
+    auto it = s_byPath.find(path);
+    return it != s_byPath.end() ? it->second : kNoAsset;
+}
+
+const std::string& AssetRegistry::Name(AssetId id) {
+    return entryFor(id).name;
+}
+
+const std::string& AssetRegistry::Path(AssetId id) {
+    return entryFor(id).path;
+}
+
+size_t AssetRegistry::Count() {
+    return s_count.load(std::memory_order_acquire);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Small dense index of an interned asset name. 0 is the empty name (what a new Entity holds).
+using AssetId = uint32_t;
+constexpr AssetId kNoAsset = 0;
+
+/**
+ * AssetRegistry: Interns asset names ("grass") into AssetIds, so per-frame code indexes
+ * arrays instead of hashing strings, and keeps each asset's texture path next to its name.
+ * Ids are never freed or reused and stay valid across scenes.
+ *
+ * Intern(), Find() and FindPath() are main-thread only. Name() and Path() may be called from
+ * any thread for an id it was handed: entries live in fixed blocks that never move.
+ */
+class AssetRegistry {
+public:
+    static constexpr const char* kAssetFolder = "src/assets/";
+
+    static AssetId Intern(std::string_view name);
+    static AssetId Find(std::string_view name);     // kNoAsset if never interned
+    static AssetId FindPath(std::string_view path); // Same, by texture path
+
+    static const std::string& Name(AssetId id);
+    static const std::string& Path(AssetId id);     // kAssetFolder + name + ".png"
+    static size_t Count();                          // Ids handed out so far, including kNoAsset
+};
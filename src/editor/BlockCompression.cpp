@@ -0,0 +1,338 @@
+#include "BlockCompression.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+    struct Color {
+        int r, g, b;
+    };
+
+    uint16_t packRGB565(int r, int g, int b) {
+        int r5 = (r * 31 + 127) / 255;
+        int g6 = (g * 63 + 127) / 255;
+        int b5 = (b * 31 + 127) / 255;
+        return static_cast<uint16_t>((r5 << 11) | (g6 << 5) | b5);
+    }
+
+    Color unpackRGB565(uint16_t c) {
+        int r5 = (c >> 11) & 31, g6 = (c >> 5) & 63, b5 = c & 31;
+        return { (r5 << 3) | (r5 >> 2), (g6 << 2) | (g6 >> 4), (b5 << 3) | (b5 >> 2) };
+    }
+
+    // Same palette the decoder (and the GPU) builds, always in 4-colour mode
+    void colorPalette(uint16_t c0, uint16_t c1, Color palette[4]) {
+        palette[0] = unpackRGB565(c0);
+        palette[1] = unpackRGB565(c1);
+        palette[2] = { (2 * palette[0].r + palette[1].r) / 3, (2 * palette[0].g + palette[1].g) / 3, (2 * palette[0].b + palette[1].b) / 3 };
+        palette[3] = { (palette[0].r + 2 * palette[1].r) / 3, (palette[0].g + 2 * palette[1].g) / 3, (palette[0].b + 2 * palette[1].b) / 3 };
+    }
+
+    int distance2(const Color& a, const unsigned char* p) {
+        int dr = a.r - p[0], dg = a.g - p[1], db = a.b - p[2];
+        return dr * dr + dg * dg + db * db;
+    }
+
+    // Picks the nearest palette entry per pixel, returns the squared error of the pixels in `mask`
+    int assignIndices(const unsigned char block[16][4], uint16_t mask, uint16_t c0, uint16_t c1, uint32_t& indices) {
+        Color palette[4];
+        colorPalette(c0, c1, palette);
+        indices = 0;
+        int error = 0;
+        for (int i = 0; i < 16; i++) {
+            int best = 0, bestDist = distance2(palette[0], block[i]);
+            for (int j = 1; j < 4; j++) {
+                int d = distance2(palette[j], block[i]);
+                if (d < bestDist) { best = j; bestDist = d; }
+            }
+            indices |= static_cast<uint32_t>(best) << (2 * i);
+            if (mask & (1u << i)) error += bestDist;
+        }
+        return error;
+    }
+
+    // Least-squares endpoints for fixed indices (weights 1, 2/3, 1/3, 0 for palette 0..3)
+    bool refineEndpoints(const unsigned char block[16][4], uint16_t mask, uint32_t indices, uint16_t& c0, uint16_t& c1) {
+        static const float kWeight[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+        float aa = 0, bb = 0, ab = 0;
+        float ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 };
+        for (int i = 0; i < 16; i++) {
+            if (!(mask & (1u << i))) continue;
+            float a = kWeight[(indices >> (2 * i)) & 3];
+            float b = 1.0f - a;
+            aa += a * a; bb += b * b; ab += a * b;
+            for (int c = 0; c < 3; c++) {
+                ax[c] += a * block[i][c];
+                bx[c] += b * block[i][c];
+            }
+        }
+        float det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f) return false;
+
+        int e0[3], e1[3];
+        for (int c = 0; c < 3; c++) {
+            float v0 = (ax[c] * bb - bx[c] * ab) / det;
+            float v1 = (bx[c] * aa - ax[c] * ab) / det;
+            e0[c] = std::clamp(static_cast<int>(std::lround(v0)), 0, 255);
+            e1[c] = std::clamp(static_cast<int>(std::lround(v1)), 0, 255);
+        }
+        c0 = packRGB565(e0[0], e0[1], e0[2]);
+        c1 = packRGB565(e1[0], e1[1], e1[2]);
+        return true;
+    }
+
+    void encodeColorBlock(const unsigned char block[16][4], bool skipTransparent, unsigned char* out) {
+        // Fully transparent pixels don't need a good colour; fit the rest if there are any
+        int fit[16], fitCount = 0;
+        uint16_t mask = 0;
+        for (int i = 0; i < 16; i++) {
+            if (!skipTransparent || block[i][3] != 0) {
+                fit[fitCount++] = i;
+                mask |= 1u << i;
+            }
+        }
+        if (fitCount == 0) {
+            for (int i = 0; i < 16; i++) fit[i] = i;
+            fitCount = 16;
+            mask = 0xFFFF;
+        }
+
+        // Principal axis of the colours by power iteration on their covariance
+        float mean[3] = { 0, 0, 0 };
+        for (int k = 0; k < fitCount; k++) {
+            const unsigned char* p = block[fit[k]];
+            for (int c = 0; c < 3; c++) mean[c] += p[c];
+        }
+        for (float& m : mean) m /= fitCount;
+
+        float cov[6] = { 0, 0, 0, 0, 0, 0 }; // rr rg rb gg gb bb
+        for (int k = 0; k < fitCount; k++) {
+            const unsigned char* p = block[fit[k]];
+            float r = p[0] - mean[0], g = p[1] - mean[1], b = p[2] - mean[2];
+            cov[0] += r * r; cov[1] += r * g; cov[2] += r * b;
+            cov[3] += g * g; cov[4] += g * b; cov[5] += b * b;
+        }
+
+        // Start from the covariance column of the widest channel: never orthogonal to the
+        // principal axis (a bounding box diagonal is, for anti-correlated channels)
+        int widest = (cov[0] >= cov[3] && cov[0] >= cov[5]) ? 0 : (cov[3] >= cov[5] ? 1 : 2);
+        static const int kColumn[3][3] = { { 0, 1, 2 }, { 1, 3, 4 }, { 2, 4, 5 } };
+        float axis[3] = { cov[kColumn[widest][0]], cov[kColumn[widest][1]], cov[kColumn[widest][2]] };
+        for (int iter = 0; iter < 8; iter++) {
+            float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+            float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+            float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+            float len = std::max({ std::fabs(x), std::fabs(y), std::fabs(z) });
+            if (len < 1e-6f) break;
+            axis[0] = x / len; axis[1] = y / len; axis[2] = z / len;
+        }
+
+        // Extreme pixels along the axis become the endpoints
+        int minIndex = fit[0], maxIndex = fit[0];
+        float minDot = 1e30f, maxDot = -1e30f;
+        for (int k = 0; k < fitCount; k++) {
+            const unsigned char* p = block[fit[k]];
+            float d = p[0] * axis[0] + p[1] * axis[1] + p[2] * axis[2];
+            if (d < minDot) { minDot = d; minIndex = fit[k]; }
+            if (d > maxDot) { maxDot = d; maxIndex = fit[k]; }
+        }
+
+        uint16_t c0 = packRGB565(block[maxIndex][0], block[maxIndex][1], block[maxIndex][2]);
+        uint16_t c1 = packRGB565(block[minIndex][0], block[minIndex][1], block[minIndex][2]);
+        uint32_t indices = 0;
+        int error = assignIndices(block, mask, c0, c1, indices);
+
+        // One least-squares pass; kept only if it actually lowers the error
+        uint16_t r0 = c0, r1 = c1;
+        if (c0 != c1 && refineEndpoints(block, mask, indices, r0, r1)) {
+            uint32_t refinedIndices = 0;
+            int refinedError = assignIndices(block, mask, r0, r1, refinedIndices);
+            if (refinedError < error) {
+                c0 = r0; c1 = r1; indices = refinedIndices; error = refinedError;
+            }
+        }
+
+        // 4-colour mode needs c0 > c1: swap endpoints and remap 0<->1, 2<->3
+        if (c0 < c1) {
+            std::swap(c0, c1);
+            indices ^= 0x55555555u;
+        }
+        else if (c0 == c1) {
+            indices = 0;
+        }
+
+        out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+        out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+        for (int i = 0; i < 4; i++) out[4 + i] = (indices >> (8 * i)) & 0xFF;
+    }
+
+    void alphaPalette(int a0, int a1, int palette[8]) {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1) {
+            for (int i = 1; i <= 6; i++) palette[1 + i] = ((7 - i) * a0 + i * a1) / 7;
+        }
+        else {
+            for (int i = 1; i <= 4; i++) palette[1 + i] = ((5 - i) * a0 + i * a1) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void encodeAlphaBlock(const unsigned char block[16][4], unsigned char* out) {
+        int a0 = 0, a1 = 255;
+        for (int i = 0; i < 16; i++) {
+            a0 = std::max<int>(a0, block[i][3]);
+            a1 = std::min<int>(a1, block[i][3]);
+        }
+
+        int palette[8];
+        alphaPalette(a0, a1, palette);
+        uint64_t indices = 0;
+        if (a0 != a1) {
+            for (int i = 0; i < 16; i++) {
+                int best = 0, bestDist = 256;
+                for (int j = 0; j < 8; j++) {
+                    int d = std::abs(palette[j] - block[i][3]);
+                    if (d < bestDist) { best = j; bestDist = d; }
+                }
+                indices |= static_cast<uint64_t>(best) << (3 * i);
+            }
+        }
+
+        out[0] = static_cast<unsigned char>(a0);
+        out[1] = static_cast<unsigned char>(a1);
+        for (int i = 0; i < 6; i++) out[2 + i] = (indices >> (8 * i)) & 0xFF;
+    }
+
+    // Copies the 4x4 block at (bx, by), clamping reads to the image edge
+    void fetchBlock(const unsigned char* rgba, int width, int height, int bx, int by, unsigned char block[16][4]) {
+        for (int y = 0; y < 4; y++) {
+            int sy = std::min(by * 4 + y, height - 1);
+            for (int x = 0; x < 4; x++) {
+                int sx = std::min(bx * 4 + x, width - 1);
+                std::memcpy(block[y * 4 + x], rgba + (static_cast<size_t>(sy) * width + sx) * 4, 4);
+            }
+        }
+    }
+}
+
+size_t BlockCompressor::BlockBytes(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1: return 8;
+    case BlockFormat::BC3: return 16;
+    default: return 0;
+    }
+}
+
+size_t BlockCompressor::EncodedSize(int width, int height, BlockFormat format) {
+    size_t blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    return blocksX * blocksY * BlockBytes(format);
+}
+
+BlockFormat BlockCompressor::ChooseFormat(const unsigned char* rgba, int width, int height) {
+    size_t pixels = static_cast<size_t>(width) * height;
+    for (size_t i = 0; i < pixels; i++) {
+        if (rgba[i * 4 + 3] != 255) return BlockFormat::BC3;
+    }
+    return BlockFormat::BC1;
+}
+
+std::vector<unsigned char> BlockCompressor::Encode(const unsigned char* rgba, int width, int height, BlockFormat format) {
+    std::vector<unsigned char> out(EncodedSize(width, height, format));
+    if (out.empty()) return out;
+
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    size_t blockBytes = BlockBytes(format);
+    unsigned char* dst = out.data();
+    unsigned char block[16][4];
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            fetchBlock(rgba, width, height, bx, by, block);
+            if (format == BlockFormat::BC3) {
+                encodeAlphaBlock(block, dst);
+                encodeColorBlock(block, true, dst + 8);
+            }
+            else {
+                encodeColorBlock(block, false, dst);
+            }
+            dst += blockBytes;
+        }
+    }
+    return out;
+}
+
+std::vector<unsigned char> BlockCompressor::Decode(const unsigned char* blocks, int width, int height, BlockFormat format) {
+    std::vector<unsigned char> rgba(static_cast<size_t>(width) * height * 4);
+    size_t blockBytes = BlockBytes(format);
+    if (blockBytes == 0) return rgba;
+
+    int blocksX = (width + 3) / 4, blocksY = (height + 3) / 4;
+    const unsigned char* src = blocks;
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            const unsigned char* color = (format == BlockFormat::BC3) ? src + 8 : src;
+            uint16_t c0 = color[0] | (color[1] << 8);
+            uint16_t c1 = color[2] | (color[3] << 8);
+            uint32_t indices = color[4] | (color[5] << 8) | (color[6] << 16) | (static_cast<uint32_t>(color[7]) << 24);
+
+            Color palette[4];
+            colorPalette(c0, c1, palette);
+            bool punchThrough = false;
+            if (format == BlockFormat::BC1 && c0 <= c1) {
+                // 3-colour mode (never written by Encode, but valid BC1)
+                palette[2] = { (palette[0].r + palette[1].r) / 2, (palette[0].g + palette[1].g) / 2, (palette[0].b + palette[1].b) / 2 };
+                palette[3] = { 0, 0, 0 };
+                punchThrough = true;
+            }
+
+            int alphas[8] = { 255, 255, 255, 255, 255, 255, 255, 255 };
+            uint64_t alphaIndices = 0;
+            if (format == BlockFormat::BC3) {
+                alphaPalette(src[0], src[1], alphas);
+                for (int i = 0; i < 6; i++) alphaIndices |= static_cast<uint64_t>(src[2 + i]) << (8 * i);
+            }
+
+            for (int i = 0; i < 16; i++) {
+                int x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+                if (x >= width || y >= height) continue;
+
+                int index = (indices >> (2 * i)) & 3;
+                unsigned char* p = &rgba[(static_cast<size_t>(y) * width + x) * 4];
+                p[0] = static_cast<unsigned char>(palette[index].r);
+                p[1] = static_cast<unsigned char>(palette[index].g);
+                p[2] = static_cast<unsigned char>(palette[index].b);
+                if (format == BlockFormat::BC3)
+                    p[3] = static_cast<unsigned char>(alphas[(alphaIndices >> (3 * i)) & 7]);
+                else
+                    p[3] = (punchThrough && index == 3) ? 0 : 255;
+            }
+            src += blockBytes;
+        }
+    }
+    return rgba;
+}
+
+BlockCompressor::ErrorStats BlockCompressor::Measure(const unsigned char* rgba, int width, int height, BlockFormat format) {
+    std::vector<unsigned char> blocks = Encode(rgba, width, height, format);
+    std::vector<unsigned char> decoded = Decode(blocks.data(), width, height, format);
+
+    ErrorStats stats;
+    double sum = 0.0;
+    size_t count = decoded.size();
+    size_t compared = 0;
+    for (size_t i = 0; i < count; i++) {
+        // The colour of fully transparent pixels is never seen, BC3 doesn't try to keep it
+        bool transparentColor = format == BlockFormat::BC3 && (i & 3) != 3 && rgba[i | 3] == 0;
+        if (transparentColor) continue;
+
+        int diff = std::abs(static_cast<int>(decoded[i]) - static_cast<int>(rgba[i]));
+        sum += static_cast<double>(diff) * diff;
+        stats.maxError = std::max(stats.maxError, diff);
+        compared++;
+    }
+    stats.rmse = compared ? std::sqrt(sum / compared) : 0.0;
+    return stats;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// S3TC / DXT block formats. BC1 = 8 bytes per 4x4 block (RGB), BC3 = 16 bytes (RGB + smooth alpha).
+enum class BlockFormat : uint32_t {
+    None = 0,
+    BC1 = 1,
+    BC3 = 3,
+};
+
+/**
+ * BlockCompressor: CPU encoder/decoder for BC1 and BC3. Fully deterministic (fixed
+ * iteration counts, no randomness, no threading), so the same pixels always give the
+ * same bytes and cached output can be compared against a fresh encode.
+ *
+ * Input is tightly packed RGBA8; sizes that aren't a multiple of 4 are handled by
+ * clamping to the edge inside the last row/column of blocks. Decode() exists to verify
+ * the encoder on the CPU (see ErrorStats), the GPU does the real decoding.
+ */
+class BlockCompressor {
+public:
+    struct ErrorStats {
+        double rmse = 0.0;   // Over all RGBA channels, 0..255 scale
+        int maxError = 0;    // Largest single channel difference
+    };
+
+    static size_t BlockBytes(BlockFormat format);
+    static size_t EncodedSize(int width, int height, BlockFormat format);
+
+    // BC1 if every pixel is opaque, BC3 otherwise
+    static BlockFormat ChooseFormat(const unsigned char* rgba, int width, int height);
+
+    static std::vector<unsigned char> Encode(const unsigned char* rgba, int width, int height, BlockFormat format);
+    static std::vector<unsigned char> Decode(const unsigned char* blocks, int width, int height, BlockFormat format);
+
+    // Encodes, decodes and compares against the source
+    static ErrorStats Measure(const unsigned char* rgba, int width, int height, BlockFormat format);
+};
@@ -0,0 +1,28 @@
+#include "CameraUniforms.h"
+#include "Shader.h"
+#include <cstring>
+
+CameraUniforms::~CameraUniforms() {
+    if (m_ubo) glDeleteBuffers(1, &m_ubo);
+}
+
+void CameraUniforms::init() {
+    glGenBuffers(1, &m_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // Indexed binding, nothing else in the editor uses this binding point
+    glBindBufferBase(GL_UNIFORM_BUFFER, Shader::kCameraBlockBinding, m_ubo);
+}
+
+void CameraUniforms::update(const glm::mat4& viewProjection, const glm::vec4& viewRect, const glm::vec4& viewport) {
+    CameraBlock block{ viewProjection, viewRect, viewport };
+    if (m_hasUploaded && std::memcmp(&block, &m_uploaded, sizeof(block)) == 0) return;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_ubo);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    m_uploaded = block;
+    m_hasUploaded = true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// std140 layout of the "Camera" uniform block declared by the shaders
+struct CameraBlock {
+    glm::mat4 viewProjection;
+    glm::vec4 viewRect;  // Visible world rect: left, bottom, right, top
+    glm::vec4 viewport;  // x, y, width, height in pixels
+};
+static_assert(sizeof(CameraBlock) == 96, "CameraBlock must match the std140 Camera block");
+
+/**
+ * CameraUniforms: One uniform buffer with the camera matrices, bound to
+ * Shader::kCameraBlockBinding so every program with a Camera block reads the same data.
+ * update() is called once per frame and only uploads when the camera actually changed.
+ */
+class CameraUniforms {
+public:
+    CameraUniforms() = default;
+    ~CameraUniforms();
+
+    CameraUniforms(const CameraUniforms&) = delete;
+    CameraUniforms& operator=(const CameraUniforms&) = delete;
+
+    void init();
+    void update(const glm::mat4& viewProjection, const glm::vec4& viewRect, const glm::vec4& viewport);
+
+private:
+    GLuint m_ubo = 0;
+    CameraBlock m_uploaded{};
+    bool m_hasUploaded = false;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <atomic>
+#include <utility>
+
+/**
+ * CompletionQueue: Lock-free multi-producer, single-consumer queue for handing finished
+ * work from worker threads back to the main thread. Producers push with one CAS on the
+ * head; the consumer takes the whole list in one exchange and walks it oldest first.
+ * Because only the consumer ever removes nodes, and always all of them, there is no ABA.
+ */
+template <typename T>
+class CompletionQueue {
+public:
+    CompletionQueue() = default;
+    ~CompletionQueue() { drain([](T&) {}); }
+
+    CompletionQueue(const CompletionQueue&) = delete;
+    CompletionQueue& operator=(const CompletionQueue&) = delete;
+
+    // Any thread
+    void push(T value) {
+        Node* node = new Node{ std::move(value), m_head.load(std::memory_order_relaxed) };
+        while (!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * Drain: Calls visit(T&) for everything pushed so far, in push order. Consumer thread
+     * only. Returns the number of items visited.
+     */
+    template <typename Visitor>
+    int drain(Visitor&& visit) {
+        Node* list = m_head.exchange(nullptr, std::memory_order_acquire);
+
+        // The stack comes out newest first
+        Node* ordered = nullptr;
+        while (list) {
+            Node* next = list->next;
+            list->next = ordered;
+            ordered = list;
+            list = next;
+        }
+
+        int count = 0;
+        while (ordered) {
+            Node* next = ordered->next;
+            visit(ordered->value);
+            delete ordered;
+            ordered = next;
+            count++;
+        }
+        return count;
+    }
+
+    bool empty() const { return m_head.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        T value;
+        Node* next;
+    };
+
+    std::atomic<Node*> m_head{ nullptr };
+};
@@ -1,9 +1,10 @@
 ﻿#include "Editor.h"
 #include "SceneSerializer.h"
 #include "AssetManager.h"
+#include "Profiler.h"
 
-Editor::Editor(Window& window)
-    : m_window(window)
+Editor::Editor(Window& window, const TextureStreamSettings& textureSettings)
+    : m_window(window), textureStreamSettings(textureSettings)
 {
     // Set this Editor instance as GLFW user pointer for callbacks
     glfwSetWindowUserPointer(m_window.getHandle(), this);
@@ -17,11 +18,17 @@ Editor::Editor(Window& window)
 
     // ===== Load shaders =====
     m_gridShader = Shader("src/shaders/grid.vert", "src/shaders/grid.frag");
+    m_lineShader = Shader("src/shaders/line.vert", "src/shaders/line.frag");
     m_spriteShader = Shader("src/shaders/sprite.vert", "src/shaders/sprite.frag");
+    m_instancedShader = Shader("src/shaders/sprite_instanced.vert", "src/shaders/sprite.frag");
+    m_arrayShader = Shader("src/shaders/sprite_array.vert", "src/shaders/sprite_array.frag");
     
     // Initialize grid buffers AFTER shaders are loaded (needs shader IDs for uniform locations)
     initGridBuffers();
 
+    // Every program reads the camera from this one buffer
+    m_cameraUniforms.init();
+
     // ===== Quad geometry =====
     float verts[] = {
         // pos      // tex
@@ -51,56 +58,60 @@ Editor::Editor(Window& window)
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
+    // Streaming batch for entities, same vertex layout as the quad above
+    m_spriteBatch.init(m_streamBuffer);
+
+    // Instanced path draws the same unit quad, one instance per tile
+    m_instancedRenderer.init(m_quadVAO, m_instancedShader);
+    m_spatialGrid.setCellSize(cellWidth, cellHeight);
+
+    // Array path: 2D fallback textures on unit 0, the texture array stays on unit 1
+    m_arrayShader.use();
+    m_arrayShader.setInt("uTexture", 0);
+    m_arrayShader.setInt("uTextureArray", 1);
 
     // Load asset list 
     newScene("Untitled");
 
     std::string assetFolder = "src/assets";
+    bool onDemand = textureStreamSettings.residencyBudgetBytes > 0;
+    AssetManager::SetResidencyBudget(textureStreamSettings.residencyBudgetBytes);
 
     if (!fs::exists(assetFolder)) {
         std::cerr << "Assets folder not found: " << fs::absolute(assetFolder) << std::endl;
+        m_texturesFinalized = true;
     }
     else {
-        std::vector<std::future<TextureData*>> futures;
-
+        std::vector<std::string> texturePaths;
         for (auto& entry : fs::directory_iterator(assetFolder)) {
             if (entry.is_regular_file() && entry.path().extension() == ".png") {
-                std::string assetName = entry.path().stem().string();
-                assetList.push_back(assetName);
-
-                // Start async loading
-                std::string fullPath = "src/assets/" + assetName + ".png";
-                futures.push_back(AssetManager::LoadTextureAsync(fullPath));
+                AssetId asset = AssetRegistry::Intern(entry.path().stem().string());
+                assetList.push_back(asset);
+                texturePaths.push_back(AssetRegistry::Path(asset));
             }
         }
 
-        // ⭐ START TIMING ⭐
-        auto startTime = std::chrono::high_resolution_clock::now();
+        // Textures in the pack load from its mapping; any it couldn't bake still decode
+        if (textureStreamSettings.assetPack)
+            AssetManager::OpenAssetPack(kAssetPackPath, texturePaths);
 
-        // Wait for all textures to load on CPU
-        for (auto& future : futures) {
-            future.wait();
+        // Start async loading (decoded on AssetManager's pool); on demand, the first
+        // draw or thumbnail that needs the texture does this instead
+        if (!onDemand) {
+            for (const std::string& path : texturePaths)
+                AssetManager::LoadTextureAsync(path);
         }
 
-        auto cpuLoadTime = std::chrono::high_resolution_clock::now();
-        std::cout << "CPU load time: "
-            << std::chrono::duration_cast<std::chrono::milliseconds>(cpuLoadTime - startTime).count()
-            << "ms\n";
+        m_textureLoadStats.total = static_cast<int>(assetList.size());
 
-        // Batch upload to GPU (FAST - single pass)
-        AssetManager::UploadAllTexturesToGPU();
+        // Palette thumbnails, made in the background from the pack or the PNGs
+        AssetManager::BuildThumbnailAtlas(assetList);
 
-        auto gpuUploadTime = std::chrono::high_resolution_clock::now();
-        std::cout << "GPU upload time: "
-            << std::chrono::duration_cast<std::chrono::milliseconds>(gpuUploadTime - cpuLoadTime).count()
-            << "ms\n";
-
-        std::cout << "Total texture loading time: "
-            << std::chrono::duration_cast<std::chrono::milliseconds>(gpuUploadTime - startTime).count()
-            << "ms\n";
-
-        // Optional: Free CPU memory after upload
-        AssetManager::FreeCPUDataForLoadedTextures();
+        // Progressive: decoding runs in the background and run() uploads as textures land
+        if (onDemand)
+            m_texturesFinalized = true; // Nothing to wait for and no atlas or array to build
+        else if (!textureStreamSettings.progressive)
+            finishTextureLoading();
     }
 
     if (!assetList.empty())
@@ -114,6 +125,7 @@ Editor::Editor(Window& window)
 Editor::~Editor()
 {
     AssetManager::Shutdown();
+    Profiler::Shutdown();
     shutdownImGui();
     // Shaders auto-clean through Shader destructor
         // Delete physics world
@@ -140,41 +152,44 @@ void Editor::shutdownImGui()
 void Editor::initGridBuffers() {
     if (gridBuffersInitialized) return;
 
-    // Create VAO/VBO for grid
+    // All per-frame geometry (game-view box, sprite batches) is written into this one buffer
+    m_streamBuffer.init(kStreamRegionBytes);
+
+    // Full-viewport quad in NDC, drawn as a triangle strip
+    float gridQuad[] = { -1.0f, -1.0f,  1.0f, -1.0f,  -1.0f, 1.0f,  1.0f, 1.0f };
+
     glGenVertexArrays(1, &gridVAO);
     glGenBuffers(1, &gridVBO);
     
     glBindVertexArray(gridVAO);
     glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(gridQuad), gridQuad, GL_STATIC_DRAW);
     // Set up vertex attributes (position: 2 floats)
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     glBindVertexArray(0); // Unbind
 
-    // Create VAO/VBO for box
+    // Create VAO for box, its vertices are streamed every frame
     glGenVertexArrays(1, &boxVAO);
-    glGenBuffers(1, &boxVBO);
     
     glBindVertexArray(boxVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, m_streamBuffer.handle());
     // Set up vertex attributes (position: 2 floats)
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     glBindVertexArray(0); // Unbind
 
     // Cache uniform locations (must be called AFTER shaders are loaded!)
-    uProjectionLoc = glGetUniformLocation(m_gridShader.id, "uProjection");
-    uGridColorLoc = glGetUniformLocation(m_gridShader.id, "uColor");
-
-    // Cache sprite MVP uniform
-    uMVPLoc = glGetUniformLocation(m_spriteShader.id, "uMVP");
+    uGridCellSizeLoc = m_gridShader.location("uCellSize");
+    uGridColorLoc = m_gridShader.location("uColor");
+    uLineColorLoc = m_lineShader.location("uColor");
 
     // Verify uniform locations are valid
-    if (uProjectionLoc == -1 || uGridColorLoc == -1 || uMVPLoc == -1) {
+    if (uGridCellSizeLoc == -1 || uGridColorLoc == -1 || uLineColorLoc == -1) {
         std::cerr << "WARNING: Invalid uniform locations detected!\n";
-        std::cerr << "  uProjectionLoc: " << uProjectionLoc << "\n";
+        std::cerr << "  uGridCellSizeLoc: " << uGridCellSizeLoc << "\n";
         std::cerr << "  uGridColorLoc: " << uGridColorLoc << "\n";
-        std::cerr << "  uMVPLoc: " << uMVPLoc << "\n";
+        std::cerr << "  uLineColorLoc: " << uLineColorLoc << "\n";
     }
 
     gridBuffersInitialized = true;
@@ -184,60 +199,212 @@ void Editor::run()
 {
     while (!m_window.shouldClose())
     {
-        m_window.pollEvents();
+        // On demand: sleeps here until input, an edit or the idle heartbeat
+        m_framePacer.waitForEvents(m_window);
+        m_framePacer.beginFrame();
+        Profiler::BeginFrame();
         glfwGetWindowSize(m_window.getHandle(), &windowWidth, &windowHeight);
 
-        ImGui_ImplOpenGL3_NewFrame();
-        ImGui_ImplGlfw_NewFrame();
-        ImGui::NewFrame();
-
-
-        // ===== MENU BAR =====
-        if (ImGui::BeginMainMenuBar()) {
-            if (ImGui::BeginMenu("File")) {
-                if (ImGui::MenuItem("New Scene")) newScene("Untitled");
-                if (ImGui::MenuItem("Open Scene...")) openSceneDialog();
-                if (ImGui::MenuItem("Save Scene")) saveScene(currentScene.path);
-                if (ImGui::MenuItem("Save Scene As...")) saveSceneDialog();
-                ImGui::Separator();
-                if (ImGui::MenuItem("Exit"))
-                    glfwSetWindowShouldClose(m_window.getHandle(), true);
-                ImGui::EndMenu();
+        streamTextures();
+
+        {
+            PROFILE_SCOPE("ImGui build");
+            ImGui_ImplOpenGL3_NewFrame();
+            ImGui_ImplGlfw_NewFrame();
+            ImGui::NewFrame();
+
+
+            // ===== MENU BAR =====
+            if (ImGui::BeginMainMenuBar()) {
+                if (ImGui::BeginMenu("File")) {
+                    if (ImGui::MenuItem("New Scene")) newScene("Untitled");
+                    if (ImGui::MenuItem("Open Scene...")) openSceneDialog();
+                    if (ImGui::MenuItem("Save Scene")) saveScene(currentScene.path);
+                    if (ImGui::MenuItem("Save Scene As...")) saveSceneDialog();
+                    ImGui::Separator();
+                    if (ImGui::MenuItem("Exit"))
+                        glfwSetWindowShouldClose(m_window.getHandle(), true);
+                    ImGui::EndMenu();
+                }
+                ImGui::EndMainMenuBar();
             }
-            ImGui::EndMainMenuBar();
-        }
 
 
-        renderImGuiPanel();
-        handleEntityPlacement();
+            renderImGuiPanel();
+        }
+        {
+            PROFILE_SCOPE("Input");
+            handleEntityPlacement();
+        }
 
 
         // ================================
         // SCENE RENDERING
         // ================================
-        glEnable(GL_SCISSOR_TEST);
-        glViewport(kLeftPanelWidth, 0, windowWidth - kLeftPanelWidth, windowHeight);
-        glScissor(kLeftPanelWidth, 0, windowWidth - kLeftPanelWidth, windowHeight);
+        renderSceneView();
 
-        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
 
-        glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        // ===== ImGui Render =====
+        {
+            PROFILE_SCOPE("ImGui render");
+            PROFILE_GPU_SCOPE("ImGui render");
+            ImGui::Render();
+            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        drawInfiniteGrid();
-        drawEntities();
+        {
+            PROFILE_SCOPE("Swap");
+            m_window.swapBuffers();
+        }
+        if (m_textureLoadStats.firstFrameMs == 0.0) {
+            m_textureLoadStats.firstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+            std::cout << "Time to first frame: " << m_textureLoadStats.firstFrameMs << "ms\n";
+        }
+        Profiler::EndFrame();
+        m_framePacer.endFrame();
+    }
+}
 
-        glDisable(GL_SCISSOR_TEST);
-        glViewport(0, 0, windowWidth, windowHeight);
+// Once per frame until every texture is resident: hands decoded textures to the GPU within
+// the upload budget, then builds the atlas and texture array from the complete set
+void Editor::streamTextures() {
+    // Palette thumbnails land on their own schedule, whatever mode the textures load in
+    if (AssetManager::UploadPendingThumbnails() > 0 || AssetManager::PendingThumbnails() > 0)
+        m_framePacer.markDirty(FramePacer::DirtyUI);
+
+    bool onDemand = textureStreamSettings.residencyBudgetBytes > 0;
+    if (m_texturesFinalized && !onDemand) return;
+    PROFILE_SCOPE("Stream textures");
+
+    // Read before draining: decode jobs publish before the count drops, so 0 here means
+    // the drain below sees every result
+    bool decoded = AssetManager::PendingTextureLoads() == 0;
+    AssetManager::ProcessCompletedLoads();
+    m_textureLoadStats.resident += AssetManager::UploadPendingTextures(
+        textureStreamSettings.maxUploadBytes, textureStreamSettings.maxUploadMs);
+
+    if (onDemand) {
+        // Evicts what wasn't requested last frame if over budget; requests come from drawEntities
+        AssetManager::UpdateResidency();
+        m_textureLoadStats.resident = AssetManager::GetResidencyStats().resident;
+        if (!decoded || AssetManager::PendingTextureUploads() > 0)
+            m_framePacer.markDirty(FramePacer::DirtyScene);
+        return;
+    }
 
+    if (decoded && AssetManager::PendingTextureUploads() == 0)
+        finalizeTextures();
+    else
+        m_framePacer.markDirty(FramePacer::DirtyScene); // Keep frames coming while textures land
+}
 
-        // ===== ImGui Render =====
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+// Non-progressive path (and the render benchmark): everything in one blocking step
+void Editor::finishTextureLoading() {
+    if (m_texturesFinalized) return;
+
+    // ⭐ START TIMING ⭐
+    auto startTime = std::chrono::high_resolution_clock::now();
 
-        m_window.swapBuffers();
+    // Wait for all textures to load on CPU
+    {
+        PROFILE_SCOPE("Load textures (CPU)");
+        AssetManager::WaitForTextureLoads();
+    }
+
+    auto cpuLoadTime = std::chrono::high_resolution_clock::now();
+    std::cout << "CPU load time: "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(cpuLoadTime - startTime).count()
+        << "ms (" << AssetManager::DecodeThreadCount() << " decode threads)\n";
+
+    // Batch upload to GPU (FAST - single pass)
+    {
+        PROFILE_SCOPE("Upload textures");
+        AssetManager::UploadAllTexturesToGPU();
     }
+
+    auto gpuUploadTime = std::chrono::high_resolution_clock::now();
+    std::cout << "GPU upload time: "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(gpuUploadTime - cpuLoadTime).count()
+        << "ms\n";
+
+    std::cout << "Total texture loading time: "
+        << std::chrono::duration_cast<std::chrono::milliseconds>(gpuUploadTime - startTime).count()
+        << "ms\n";
+
+    finalizeTextures();
+}
+
+void Editor::finalizeTextures() {
+    // Pack everything into shared pages so the scene can be drawn from one texture
+    {
+        PROFILE_SCOPE("Build atlas");
+        AssetManager::BuildAtlas();
+        AssetManager::UploadAtlasToGPU();
+        m_instancedRenderer.invalidate();
+    }
+
+    // Same-size tiles also go into one texture array, entities refer to it by layer
+    {
+        PROFILE_SCOPE("Upload texture array");
+        AssetManager::UploadTextureArrayToGPU();
+    }
+
+    // Optional: Free CPU memory after upload
+    AssetManager::FreeCPUDataForLoadedTextures();
+
+    m_texturesFinalized = true;
+
+    // Tiles placed while streaming have no array layer and chunk meshes baked the placeholder
+    onSceneReplaced();
+
+    m_textureLoadStats.resident = 0;
+    for (AssetId asset : assetList) {
+        if (AssetManager::GetTextureSlot(asset).texture != 0)
+            m_textureLoadStats.resident++;
+    }
+    m_textureLoadStats.fullyLoadedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+    std::cout << "Time to fully loaded: " << m_textureLoadStats.fullyLoadedMs << "ms ("
+        << m_textureLoadStats.resident << "/" << m_textureLoadStats.total << " textures)\n";
+}
+
+// Grid and entities into the scene viewport (right of the left panel); shared with the benchmark
+void Editor::renderSceneView()
+{
+    // Don't update camera virtual size here - it causes zoom when editing red square
+    // Camera virtual size is set when loading scenes, not during editing
+    int viewportWidth = windowWidth - kLeftPanelWidth;
+    m_camera.setViewport(kLeftPanelWidth, 0, viewportWidth, windowHeight);
+    m_cameraUniforms.update(m_camera.getProjection(), m_camera.getVisibleRect(),
+        glm::vec4(kLeftPanelWidth, 0.0f, viewportWidth, windowHeight));
+
+    glEnable(GL_SCISSOR_TEST);
+    glViewport(kLeftPanelWidth, 0, windowWidth - kLeftPanelWidth, windowHeight);
+    glScissor(kLeftPanelWidth, 0, windowWidth - kLeftPanelWidth, windowHeight);
+
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    {
+        PROFILE_SCOPE("Grid");
+        PROFILE_GPU_SCOPE("Grid");
+        drawInfiniteGrid();
+    }
+    {
+        PROFILE_SCOPE("Entities");
+        PROFILE_GPU_SCOPE("Entities");
+        drawEntities();
+    }
+
+    glDisable(GL_SCISSOR_TEST);
+    glViewport(0, 0, windowWidth, windowHeight);
+
+    // Everything streamed this frame has been drawn; fence it and move on
+    m_streamBuffer.endFrame();
+    Profiler::SetCounter("Stream fence waits", m_streamBuffer.getStats().fenceWaits);
+    m_streamBuffer.resetStats();
 }
 
 void Editor::staticScrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
@@ -245,6 +412,7 @@ void Editor::staticScrollCallback(GLFWwindow* window, double xoffset, double yof
     
     Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
     if (editor) {
+        editor->m_framePacer.markDirty(FramePacer::DirtyUI);
         editor->handleScroll(xoffset, yoffset);
     }
 }
@@ -254,6 +422,7 @@ void Editor::staticMouseButtonCallback(GLFWwindow* window, int button, int actio
     
     Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
     if (editor) {
+        editor->m_framePacer.markDirty(FramePacer::DirtyUI);
         editor->handleMouseButton(button, action, mods);
     }
 }
@@ -263,10 +432,46 @@ void Editor::staticCursorPosCallback(GLFWwindow* window, double xpos, double ypo
     
     Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
     if (editor) {
+        editor->m_framePacer.markDirty(FramePacer::DirtyUI);
         editor->handleCursorPos(xpos, ypos);
     }
 }
 
+// The remaining callbacks only forward to ImGui and wake the on-demand loop
+void Editor::staticKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+
+    Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
+    if (editor) editor->m_framePacer.markDirty(FramePacer::DirtyUI);
+}
+
+void Editor::staticCharCallback(GLFWwindow* window, unsigned int c) {
+    ImGui_ImplGlfw_CharCallback(window, c);
+
+    Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
+    if (editor) editor->m_framePacer.markDirty(FramePacer::DirtyUI);
+}
+
+void Editor::staticFocusCallback(GLFWwindow* window, int focused) {
+    ImGui_ImplGlfw_WindowFocusCallback(window, focused);
+
+    Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
+    if (editor) editor->m_framePacer.markDirty(FramePacer::DirtyUI);
+}
+
+void Editor::staticCursorEnterCallback(GLFWwindow* window, int entered) {
+    ImGui_ImplGlfw_CursorEnterCallback(window, entered);
+
+    Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
+    if (editor) editor->m_framePacer.markDirty(FramePacer::DirtyUI);
+}
+
+// Resizes and exposes need a redraw even though nothing in the scene changed
+void Editor::staticWindowRefreshCallback(GLFWwindow* window) {
+    Editor* editor = static_cast<Editor*>(glfwGetWindowUserPointer(window));
+    if (editor) editor->m_framePacer.markDirty(FramePacer::DirtyUI);
+}
+
 void Editor::handleScroll(double xoffset, double yoffset) {
     const float zoomSpeed = 1.1f;
     if (yoffset > 0)
@@ -276,6 +481,7 @@ void Editor::handleScroll(double xoffset, double yoffset) {
 
     zoom = std::max(0.1f, std::min(100.0f, zoom));
     m_camera.setZoom(zoom);
+    m_framePacer.markDirty(FramePacer::DirtyCamera);
 }
 
 void Editor::handleMouseButton(int button, int action, int mods) {
@@ -304,6 +510,7 @@ void Editor::handleCursorPos(double xpos, double ypos) {
     cameraX -= static_cast<float>(dx) * moveFactor;
     cameraY += static_cast<float>(dy) * moveFactor;
     m_camera.setPosition(cameraX, cameraY);
+    m_framePacer.markDirty(FramePacer::DirtyCamera);
 }
 
 void Editor::setupCallbacks() {
@@ -312,4 +519,9 @@ void Editor::setupCallbacks() {
     glfwSetScrollCallback(handle, staticScrollCallback);
     glfwSetMouseButtonCallback(handle, staticMouseButtonCallback);
     glfwSetCursorPosCallback(handle, staticCursorPosCallback);
+    glfwSetKeyCallback(handle, staticKeyCallback);
+    glfwSetCharCallback(handle, staticCharCallback);
+    glfwSetWindowFocusCallback(handle, staticFocusCallback);
+    glfwSetCursorEnterCallback(handle, staticCursorEnterCallback);
+    glfwSetWindowRefreshCallback(handle, staticWindowRefreshCallback);
 }
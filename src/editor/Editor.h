@@ -8,7 +8,9 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <filesystem>
+#include <chrono>
 
 // OpenGL + GLM
 #include <glad/glad.h>
@@ -37,30 +39,75 @@ namespace fs = std::filesystem;
 #include "GridSettings.h"
 #include "Scene.h"
 #include "Shader.h"
+#include "CameraUniforms.h"
+#include "StreamBuffer.h"
+#include "SpriteBatch.h"
+#include "InstancedTileRenderer.h"
+#include "WorkerPool.h"
+#include "TileChunkCache.h"
+#include "SpatialGrid.h"
+#include "TileLayers.h"
+#include "FramePacer.h"
+#include "RenderBenchmark.h"
 #include "./Editor_Imgui/GridModule.h"
 #include "./Editor_Imgui/CameraModule.h"
 #include "./Editor_Imgui/AssetModule.h"
 #include "./Editor_Imgui/LayerModule.h"
+#include "./Editor_Imgui/RenderModule.h"
+#include "./Editor_Imgui/FrameModule.h"
+#include "./Editor_Imgui/ProfilerModule.h"
 
 class Editor {
 public:
 
-    GridModule grid{ cellWidth, cellHeight };
+    GridModule grid{ cellWidth, cellHeight, currentScene.grid };
     CameraModule camera{ gameViewWidth, gameViewHeight };
     AssetModule assets{ assetList, selectedType };
     LayerModule layers{ placementLayer };
-
-    explicit Editor(Window& window);
+    RenderModule render{ renderMode, m_renderStats, textureStreamSettings, m_textureLoadStats };
+    FrameModule frame{ frameSettings, m_frameStats };
+    ProfilerModule profiler;
+
+    /**
+     * Constructor: Loads shaders and starts loading the asset folder. With progressive
+     * texture streaming (the default) it returns before any texture is decoded and
+     * run() uploads them over the first frames, drawing placeholders until then.
+     */
+    explicit Editor(Window& window, const TextureStreamSettings& textureSettings = {});
     
     ~Editor();
     void run();
+
+    /**
+     * Run render benchmark: Replaces the scene with synthetic tile maps and renders each one
+     * with each mode for a fixed number of frames along a scripted camera path (pan, zoom out,
+     * zoomed-out pan). No ImGui, no swap, no frame pacing; each frame is timed up to glFinish().
+     */
+    std::vector<RenderBenchmarkResult> runRenderBenchmark(const RenderBenchmarkConfig& config);
+
+    /**
+     * Run startup benchmark: Call right after construction. Draws frames like run() would
+     * (without ImGui) until every texture is resident, timing each up to glFinish().
+     */
+    StartupBenchmarkResult runStartupBenchmark();
 private:
     // Camera
     Camera m_camera;
     // Window and rendering
     Window& m_window;
     Shader m_gridShader;
+    Shader m_lineShader;
     Shader m_spriteShader;
+    Shader m_instancedShader;
+    Shader m_arrayShader;
+    CameraUniforms m_cameraUniforms;
+    StreamBuffer m_streamBuffer;
+    SpriteBatch m_spriteBatch;
+    InstancedTileRenderer m_instancedRenderer;
+    WorkerPool m_workerPool;
+    TileChunkCache m_chunkCache{ m_workerPool };
+    SpatialGrid m_spatialGrid;
+    TileLayers m_tileLayers; // Cell -> tile per layer, for placement and picking
 
     //Accessed by ImGui via member functions
     int windowWidth = 1280;
@@ -74,34 +121,51 @@ private:
     float gameViewWidth = 2000.0f;
     float gameViewHeight = 720.0f;
     static constexpr int kLeftPanelWidth = 320;
-
-    std::vector<float> gridVertices;
-    std::vector<float> boxVertices;
+    RenderMode renderMode = RenderMode::Batched;
+    RenderStats m_renderStats;
+    FrameSettings frameSettings;
+    FrameStats m_frameStats;
+    FramePacer m_framePacer{ frameSettings, m_frameStats };
+    TextureStreamSettings textureStreamSettings;
+    TextureLoadStats m_textureLoadStats;
+    std::chrono::steady_clock::time_point m_startTime = std::chrono::steady_clock::now();
+    bool m_texturesFinalized = false; // Atlas and texture array built, CPU copies freed
+    static constexpr const char* kAssetPackPath = "src/assets.t2dpack"; // Baked from src/assets, see AssetPack
+
+    // On-demand residency (textureStreamSettings.residencyBudgetBytes > 0): assets of the
+    // visible tiles, requested every frame so they count as used
+    std::vector<AssetId> m_visibleTextureIds;
+    unsigned int m_visibleTexturesVersion = ~0u;
+
+    // Per-frame region of m_streamBuffer; must hold one full sprite batch upload (16384 quads)
+    static constexpr size_t kStreamRegionBytes = 4 * 1024 * 1024;
     GLuint m_quadVAO = 0, m_quadVBO = 0, m_EBO = 0;
     GLuint lastTextureID = 0;
-    // Grid rendering
+    // Grid rendering (one full-viewport quad, lines are computed in grid.frag)
     GLuint gridVAO = 0;
     GLuint gridVBO = 0;
     GLuint boxVAO = 0;
-    GLuint boxVBO = 0;
 
-    // Cached uniform locations
-    GLint uProjectionLoc = -1;
+    // Cached uniform locations; camera matrices are in m_cameraUniforms instead
+    GLint uGridCellSizeLoc = -1;
     GLint uGridColorLoc = -1;
-
-    // Sprite shader MVP uniform
-    GLint uMVPLoc = -1;
+    GLint uLineColorLoc = -1;
 
     // Flags
     bool gridBuffersInitialized = false;
-    bool entitiesNeedSorting = true;
+    // Bumped whenever entities are added, removed or replaced; renderers compare it to skip uploads
+    unsigned int sceneRevision = 0;
     // Scene state
     Scene currentScene;
-    std::vector<std::string> assetList;
-    std::string selectedType = "";
+    std::vector<AssetId> assetList;
+    AssetId selectedType = kNoAsset;
     
-    // Cache texture paths per entity type to avoid string concatenation every frame
-    std::unordered_map<std::string, std::string> cachedTexturePaths;
+    // Culling: tiles of the chunks overlapping the camera, regathered only when the
+    // chunk range or the scene changes
+    std::vector<uint32_t> m_visibleTiles; // Entity indices, fields read from currentScene.entities
+    ChunkRange m_visibleRange;
+    unsigned int m_visibleRevision = ~0u;
+    unsigned int m_visibleSetVersion = 0;
 
     // Input state
     bool isPanning = false;
@@ -111,6 +175,11 @@ private:
     static void staticScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
     static void staticMouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
     static void staticCursorPosCallback(GLFWwindow* window, double xpos, double ypos);
+    static void staticKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
+    static void staticCharCallback(GLFWwindow* window, unsigned int c);
+    static void staticFocusCallback(GLFWwindow* window, int focused);
+    static void staticCursorEnterCallback(GLFWwindow* window, int entered);
+    static void staticWindowRefreshCallback(GLFWwindow* window);
 
     void handleScroll(double xoffset, double yoffset);
     void handleMouseButton(int button, int action, int mods);
@@ -120,11 +189,27 @@ private:
     void shutdownImGui();
     void renderImGuiPanel();
     void initGridBuffers();
+    void renderSceneView();
+    void streamTextures();
+    void finishTextureLoading();
+    void finalizeTextures();
+    void generateBenchmarkScene(int tiles, int layers, unsigned int seed);
+    void applyBenchmarkCamera(float t, float extentX, float extentY);
     void processInput();
     void handleEntityPlacement();
+    void onTileAdded(const Entity& entity);
+    void onTileRemoved(const Entity& entity);
+    void onSceneReplaced();
+    void syncCellSize();
     glm::vec2 getMouseWorldPosition();
     void drawInfiniteGrid();
-    void drawEntities();    
+    void drawEntities();
+    void updateVisibleTiles();
+    void requestVisibleTextures();
+    void drawEntitiesBatched();
+    void drawEntitiesInstanced();
+    void drawEntitiesChunked();
+    void drawEntitiesArray();
     void newScene(const std::string& name);
     void saveScene(const std::string& path);
     void loadScene(const std::string& path);
@@ -0,0 +1,196 @@
+#include "Editor.h"
+#include "Profiler.h"
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+static constexpr int kMaxChunkWarmupFrames = 5000; // Gives up waiting on chunk jobs after this many frames
+
+// Nearest-rank percentile of already sorted samples
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+}
+
+// Square block of cells centred on the origin, `layers` tiles stacked per cell, random types
+void Editor::generateBenchmarkScene(int tiles, int layers, unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pickType(0, assetList.size() - 1);
+
+    int cells = (tiles + layers - 1) / layers;
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(cells))));
+
+    currentScene.name = "Benchmark";
+    currentScene.path.clear();
+    currentScene.entities.clear();
+    currentScene.entities.reserve(tiles);
+    for (int i = 0; i < tiles; i++) {
+        int cell = i / layers;
+        Entity entity;
+        entity.type = assetList[pickType(rng)];
+        entity.x = (cell % side - side / 2) * cellWidth + cellWidth * 0.5f;
+        entity.y = (cell / side - side / 2) * cellHeight + cellHeight * 0.5f;
+        entity.layer = i % layers;
+        currentScene.entities.create(entity);
+    }
+    onSceneReplaced();
+}
+
+/**
+ * Camera script: t in [0, 1). First 40% pans corner to corner at zoom 1, the next 30%
+ * zooms out to fit the map (clamped like the scroll wheel), the rest circles zoomed out.
+ */
+void Editor::applyBenchmarkCamera(float t, float extentX, float extentY) {
+    float fitZoom = std::clamp(gameViewHeight / (2.0f * extentY), 0.1f, 1.0f);
+    glm::vec2 corner(extentX * 0.8f, extentY * 0.8f);
+
+    glm::vec2 position;
+    if (t < 0.4f) {
+        float s = t / 0.4f;
+        position = glm::mix(-corner, corner, s);
+        zoom = 1.0f;
+    }
+    else if (t < 0.7f) {
+        float s = (t - 0.4f) / 0.3f;
+        position = glm::mix(corner, glm::vec2(0.0f), s);
+        zoom = std::pow(fitZoom, s); // Geometric, so every step looks like the same scroll tick
+    }
+    else {
+        float angle = (t - 0.7f) / 0.3f * 6.2831853f;
+        position = glm::vec2(std::cos(angle), std::sin(angle)) * (extentX * 0.25f);
+        zoom = fitZoom;
+    }
+
+    cameraX = position.x;
+    cameraY = position.y;
+    m_camera.setPosition(cameraX, cameraY);
+    m_camera.setZoom(zoom);
+}
+
+std::vector<RenderBenchmarkResult> Editor::runRenderBenchmark(const RenderBenchmarkConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<RenderBenchmarkResult> results;
+
+    // Measures drawing, not streaming: every texture resident and the atlas built first
+    finishTextureLoading();
+
+    if (assetList.empty()) {
+        std::cerr << "Benchmark: no assets loaded, nothing to draw\n";
+        return results;
+    }
+
+    glfwGetFramebufferSize(m_window.getHandle(), &windowWidth, &windowHeight);
+    RenderMode savedMode = renderMode;
+    int layerCount = std::max(config.layers, 1);
+
+    for (int tiles : config.tileCounts) {
+        generateBenchmarkScene(tiles, layerCount, config.seed);
+        int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>((tiles + layerCount - 1) / layerCount))));
+        float extentX = side * cellWidth * 0.5f;
+        float extentY = side * cellHeight * 0.5f;
+
+        for (RenderMode mode : config.modes) {
+            renderMode = mode;
+
+            // Warm-up at the start position; the chunked path also needs its first meshes built
+            applyBenchmarkCamera(0.0f, extentX, extentY);
+            for (int frame = 0; frame < config.warmupFrames ||
+                (m_chunkCache.pendingJobs() > 0 && frame < kMaxChunkWarmupFrames); frame++) {
+                Profiler::BeginFrame();
+                renderSceneView();
+                glFinish();
+                Profiler::EndFrame();
+            }
+
+            std::vector<double> frameMs;
+            frameMs.reserve(config.frames);
+            double drawCalls = 0.0;
+            double visible = 0.0;
+
+            for (int frame = 0; frame < config.frames; frame++) {
+                applyBenchmarkCamera(static_cast<float>(frame) / config.frames, extentX, extentY);
+
+                Profiler::BeginFrame();
+                auto start = Clock::now();
+                renderSceneView();
+                glFinish(); // Count the GPU work too, not just submission
+                frameMs.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+                Profiler::EndFrame();
+
+                drawCalls += m_renderStats.drawCalls;
+                visible += m_renderStats.visible;
+            }
+
+            RenderBenchmarkResult result;
+            result.tiles = tiles;
+            result.layers = layerCount;
+            result.mode = mode;
+            result.frames = config.frames;
+            if (!frameMs.empty()) {
+                double total = 0.0;
+                for (double ms : frameMs) total += ms;
+                std::sort(frameMs.begin(), frameMs.end());
+                result.meanMs = total / frameMs.size();
+                result.p50Ms = percentile(frameMs, 50.0);
+                result.p90Ms = percentile(frameMs, 90.0);
+                result.p95Ms = percentile(frameMs, 95.0);
+                result.p99Ms = percentile(frameMs, 99.0);
+                result.maxMs = frameMs.back();
+                result.avgDrawCalls = drawCalls / frameMs.size();
+                result.avgVisible = visible / frameMs.size();
+            }
+            results.push_back(result);
+
+            std::cout << "Benchmark: " << tiles << " tiles, " << RenderModeName(mode)
+                << ": p50 " << result.p50Ms << " ms, p99 " << result.p99Ms << " ms\n";
+        }
+    }
+
+    // Leave the editor as it was constructed
+    renderMode = savedMode;
+    cameraX = cameraY = 0.0f;
+    zoom = 1.0f;
+    m_camera.setPosition(cameraX, cameraY);
+    m_camera.setZoom(zoom);
+    newScene("Untitled");
+    return results;
+}
+
+StartupBenchmarkResult Editor::runStartupBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    StartupBenchmarkResult result;
+    result.progressive = textureStreamSettings.progressive;
+
+    glfwGetFramebufferSize(m_window.getHandle(), &windowWidth, &windowHeight);
+
+    // Tiles of every type on screen, so placeholders get drawn and then replaced
+    if (!assetList.empty())
+        generateBenchmarkScene(10000, 1, 1234);
+
+    do {
+        Profiler::BeginFrame();
+        auto start = Clock::now();
+        streamTextures();
+        renderSceneView();
+        glFinish();
+        auto end = Clock::now();
+        Profiler::EndFrame();
+
+        result.maxFrameMs = std::max(result.maxFrameMs, std::chrono::duration<double, std::milli>(end - start).count());
+        if (result.frames++ == 0)
+            m_textureLoadStats.firstFrameMs = std::chrono::duration<double, std::milli>(end - m_startTime).count();
+    } while (!m_texturesFinalized);
+
+    result.textures = m_textureLoadStats.resident;
+    result.firstFrameMs = m_textureLoadStats.firstFrameMs;
+    result.fullyLoadedMs = m_textureLoadStats.fullyLoadedMs;
+
+    std::cout << "Benchmark: startup (" << (result.progressive ? "progressive" : "blocking") << "): first frame "
+        << result.firstFrameMs << " ms, fully loaded " << result.fullyLoadedMs << " ms, worst frame "
+        << result.maxFrameMs << " ms\n";
+
+    newScene("Untitled");
+    return result;
+}
@@ -3,15 +3,16 @@
 #include "EditorImguiModules.h"
 #include <vector>
 #include <string>
+#include <algorithm>
 
 // AssetModule.h
 #include "../AssetManager.h"
 
 struct AssetModule : public EditorImguiModules<AssetModule> {
-    std::vector<std::string>& assetList;
-    std::string& selectedType;
+    std::vector<AssetId>& assetList;
+    AssetId& selectedType;
 
-    AssetModule(std::vector<std::string>& assets, std::string& selected)
+    AssetModule(std::vector<AssetId>& assets, AssetId& selected)
         : assetList(assets), selectedType(selected) {
     }
 
@@ -19,26 +20,60 @@ struct AssetModule : public EditorImguiModules<AssetModule> {
         ImGui::Text("Assets");
         ImGui::Separator();
         if (ImGui::BeginChild("AssetsScroll", ImVec2(0, 250), true)) {
-            const int iconsPerRow = 4;
-            int count = 0;
-            for (auto& asset : assetList) {
-                std::string path = "src/assets/" + asset + ".png";
-                GLuint texID = AssetManager::GetGPUHandle(path);
-                if (texID == 0) continue;
-
-                ImGui::PushID(asset.c_str());
-                if (ImGui::ImageButton(
-                    (std::string("##") + asset).c_str(),
-                    (ImTextureID)(intptr_t)texID,
-                    ImVec2(48, 48),
-                    ImVec2(0, 1),  // top-left
-                    ImVec2(1, 0)   // bottom-right
-                )) {
-                    selectedType = asset;
+            // Only the visible rows are laid out, and frames and thumbnails all come from the
+            // thumbnail atlas, so however big the library the palette is one draw command
+            const float thumbnailSize = static_cast<float>(ThumbnailAtlas::kCellSize);
+            const float padding = 2.0f;
+            const float buttonSize = thumbnailSize + 2.0f * padding;
+            const ImVec2 spacing = ImGui::GetStyle().ItemSpacing;
+            int iconsPerRow = std::max(1, static_cast<int>((ImGui::GetContentRegionAvail().x + spacing.x) / (buttonSize + spacing.x)));
+            int rows = (static_cast<int>(assetList.size()) + iconsPerRow - 1) / iconsPerRow;
+
+            ImTextureID atlas = (ImTextureID)(intptr_t)AssetManager::GetThumbnailAtlasHandle();
+            ThumbnailUV white = AssetManager::GetThumbnailUV(ThumbnailAtlas::kWhiteCell);
+            ImVec2 whiteUV((white.u0 + white.u1) * 0.5f, (white.v0 + white.v1) * 0.5f);
+            bool thumbnailsPending = AssetManager::PendingThumbnails() > 0;
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+            ImGuiListClipper clipper;
+            clipper.Begin(rows, buttonSize + spacing.y);
+            while (clipper.Step()) {
+                for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                    for (int column = 0; column < iconsPerRow; column++) {
+                        size_t index = static_cast<size_t>(row) * iconsPerRow + column;
+                        if (index >= assetList.size()) break;
+                        AssetId asset = assetList[index];
+                        if (column > 0) ImGui::SameLine();
+
+                        ImGui::PushID(static_cast<int>(asset));
+                        ImVec2 frameMin = ImGui::GetCursorScreenPos();
+                        if (ImGui::InvisibleButton("##asset", ImVec2(buttonSize, buttonSize))) {
+                            selectedType = asset;
+                        }
+                        int frameColour = asset == selectedType ? ImGuiCol_ButtonActive
+                            : ImGui::IsItemHovered() ? ImGuiCol_ButtonHovered : ImGuiCol_Button;
+                        ImGui::PopID();
+
+                        ImVec2 frameMax(frameMin.x + buttonSize, frameMin.y + buttonSize);
+                        ImVec2 imageMin(frameMin.x + padding, frameMin.y + padding);
+                        ImVec2 imageMax(imageMin.x + thumbnailSize, imageMin.y + thumbnailSize);
+                        drawList->AddImage(atlas, frameMin, frameMax, whiteUV, whiteUV, ImGui::GetColorU32(frameColour));
+
+                        int cell = AssetManager::GetTextureSlot(asset).thumbnailCell;
+                        if (cell >= 0) {
+                            // Rows are stored bottom first, like every other texture
+                            ThumbnailUV uv = AssetManager::GetThumbnailUV(cell);
+                            drawList->AddImage(atlas, imageMin, imageMax, ImVec2(uv.u0, uv.v1), ImVec2(uv.u1, uv.v0));
+                        }
+                        else if (!thumbnailsPending) {
+                            // No room left in the atlas: its own texture, a draw command of its own
+                            GLuint texID = AssetManager::RequestTexture(asset); // Not resident yet: checker
+                            drawList->AddImage((ImTextureID)(intptr_t)texID, imageMin, imageMax, ImVec2(0, 1), ImVec2(1, 0));
+                        }
+                    }
                 }
-                if (++count % iconsPerRow != 0) ImGui::SameLine();
-                ImGui::PopID();
             }
+            clipper.End();
             ImGui::EndChild();
         }
     }
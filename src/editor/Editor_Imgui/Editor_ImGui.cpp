@@ -34,6 +34,9 @@ void Editor::renderImGuiPanel() {
     camera.render();
     assets.render();
     layers.render();
+    render.render();
+    frame.render();
+    profiler.render();
 
     // Save/Open dialogs
     openSceneDialog();
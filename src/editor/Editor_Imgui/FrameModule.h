@@ -0,0 +1,33 @@
+#pragma once
+// FrameModule.h
+#include "EditorImguiModules.h"
+#include "../FramePacer.h"
+
+struct FrameModule : public EditorImguiModules<FrameModule> {
+    FrameSettings& settings;
+    const FrameStats& stats;
+
+    FrameModule(FrameSettings& s, const FrameStats& st) : settings(s), stats(st) {}
+
+    void renderImpl() {
+        ImGui::Text("Frame");
+        static const char* modes[] = { "Continuous", "On demand" };
+        int current = static_cast<int>(settings.mode);
+        if (ImGui::Combo("Loop", &current, modes, IM_ARRAYSIZE(modes)))
+            settings.mode = static_cast<LoopMode>(current);
+        ImGui::SliderInt("FPS cap", &settings.fpsCap, 0, 240, settings.fpsCap == 0 ? "Off" : "%d");
+        ImGui::Checkbox("VSync", &settings.vsync);
+
+        ImGui::Text("FPS: %.1f  (%.2f ms work)", stats.fps, stats.frameMs);
+        ImGui::Text("Jitter: %.2f ms", stats.jitterMs);
+        ImGui::Text("CPU: %.1f%%", stats.cpuPercent);
+        if (settings.mode == LoopMode::OnDemand) {
+            ImGui::Text("Idle wakeups: %d", stats.idleWakeups);
+            ImGui::Text("Dirty: %s%s%s",
+                (stats.lastDirty & FramePacer::DirtyScene) ? "scene " : "",
+                (stats.lastDirty & FramePacer::DirtyCamera) ? "camera " : "",
+                (stats.lastDirty & FramePacer::DirtyUI) ? "ui" : "");
+        }
+        ImGui::Separator();
+    }
+};
@@ -1,16 +1,23 @@
 #pragma once
 // GridModule.h
 #include "EditorImguiModules.h"
+#include "../GridSettings.h"
 
 struct GridModule : public EditorImguiModules<GridModule> {
     float& cellWidth;
     float& cellHeight;
+    GridSettings& settings; // The scene's: map bounds
 
-    GridModule(float& w, float& h) : cellWidth(w), cellHeight(h) {}
+    GridModule(float& w, float& h, GridSettings& s) : cellWidth(w), cellHeight(h), settings(s) {}
 
     void renderImpl() {
         ImGui::Text("Grid Settings");
         ImGui::DragFloat("Cell Width", &cellWidth, 0.5f, 0.1f, 200.0f, "%.2f");
         ImGui::DragFloat("Cell Height", &cellHeight, 0.5f, 0.1f, 200.0f, "%.2f");
+        ImGui::Checkbox("Bound Map", &settings.bounded);
+        if (settings.bounded) {
+            ImGui::DragInt("Columns", &settings.cols, 1.0f, 1, 100000);
+            ImGui::DragInt("Rows", &settings.rows, 1.0f, 1, 100000);
+        }
     }
 };
@@ -0,0 +1,92 @@
+#pragma once
+// ProfilerModule.h
+#include "EditorImguiModules.h"
+#include "../Profiler.h"
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+struct ProfilerModule : public EditorImguiModules<ProfilerModule> {
+    std::string tracePath = "profile_trace.json";
+
+    void renderImpl() {
+        if (!ImGui::CollapsingHeader("Profiler")) return;
+
+        bool enabled = Profiler::IsEnabled();
+        if (ImGui::Checkbox("Enabled", &enabled))
+            Profiler::SetEnabled(enabled);
+
+        std::vector<const Profiler::Frame*> frames = Profiler::History();
+        // Frame 0 is start-up (asset loading), it would flatten the graph
+        if (!frames.empty() && frames.front()->index == 0)
+            frames.erase(frames.begin());
+        if (frames.empty()) return;
+
+        std::vector<float> frameMs;
+        frameMs.reserve(frames.size());
+        for (const Profiler::Frame* frame : frames) {
+            frameMs.push_back(static_cast<float>(frame->durationUs / 1000.0));
+        }
+        float maxMs = *std::max_element(frameMs.begin(), frameMs.end());
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), "%.2f ms", frameMs.back());
+        ImGui::PlotLines("Frame", frameMs.data(), static_cast<int>(frameMs.size()), 0, overlay,
+            0.0f, std::max(maxMs, 16.7f), ImVec2(0, 60));
+
+        // Stage averages over the history; GPU values lag a few frames behind
+        struct Stage { const char* name; double cpuUs = 0.0; double gpuUs = 0.0; int cpuCount = 0; int gpuCount = 0; };
+        std::vector<Stage> stages;
+        auto stageFor = [&](const char* name) -> Stage& {
+            for (auto& stage : stages) {
+                if (std::strcmp(stage.name, name) == 0) return stage;
+            }
+            stages.push_back({ name });
+            return stages.back();
+        };
+        for (const Profiler::Frame* frame : frames) {
+            for (auto& zone : frame->zones) {
+                if (zone.thread != 0 || zone.depth != 0) continue;
+                Stage& stage = stageFor(zone.name);
+                stage.cpuUs += zone.durationUs;
+                stage.cpuCount++;
+            }
+            for (auto& zone : frame->gpuZones) {
+                Stage& stage = stageFor(zone.name);
+                stage.gpuUs += zone.durationUs;
+                stage.gpuCount++;
+            }
+        }
+
+        ImGui::Text("Stage            CPU ms   GPU ms");
+        for (auto& stage : stages) {
+            ImGui::Text("%-15s %7.3f  %7.3f", stage.name,
+                stage.cpuCount ? stage.cpuUs / stage.cpuCount / 1000.0 : 0.0,
+                stage.gpuCount ? stage.gpuUs / stage.gpuCount / 1000.0 : 0.0);
+        }
+
+        // Counters of the newest frame, with a graph each
+        const Profiler::Frame* newest = frames.back();
+        for (auto& counter : newest->counters) {
+            std::vector<float> values;
+            values.reserve(frames.size());
+            for (const Profiler::Frame* frame : frames) {
+                float value = 0.0f;
+                for (auto& c : frame->counters) {
+                    if (std::strcmp(c.name, counter.name) == 0) value = static_cast<float>(c.value);
+                }
+                values.push_back(value);
+            }
+            // Scaled to the counter's own peak, from 0 so a steady count doesn't look like noise
+            float maxValue = *std::max_element(values.begin(), values.end());
+            snprintf(overlay, sizeof(overlay), "%.0f", counter.value);
+            ImGui::PlotLines(counter.name, values.data(), static_cast<int>(values.size()), 0, overlay,
+                0.0f, std::max(maxValue, 1.0f), ImVec2(0, 30));
+        }
+
+        if (ImGui::Button("Export Chrome trace"))
+            Profiler::ExportChromeTrace(tracePath);
+        ImGui::Separator();
+    }
+};
@@ -0,0 +1,56 @@
+#pragma once
+// RenderModule.h
+#include "EditorImguiModules.h"
+#include "../RenderSettings.h"
+#include "../AssetManager.h"
+
+struct RenderModule : public EditorImguiModules<RenderModule> {
+    RenderMode& mode;
+    const RenderStats& stats;
+    TextureStreamSettings& streaming;
+    const TextureLoadStats& textures;
+
+    RenderModule(RenderMode& m, const RenderStats& s, TextureStreamSettings& ts, const TextureLoadStats& tl)
+        : mode(m), stats(s), streaming(ts), textures(tl) {}
+
+    void renderImpl() {
+        ImGui::Text("Render");
+        static const char* modes[] = { "Batched", "Instanced", "Chunked", "Texture array" };
+        int current = static_cast<int>(mode);
+        if (ImGui::Combo("Mode", &current, modes, IM_ARRAYSIZE(modes)))
+            mode = static_cast<RenderMode>(current);
+
+        ImGui::Text("Visible: %d  Culled: %d", stats.visible, stats.culled);
+        ImGui::Text("Sprites: %d", stats.sprites);
+        ImGui::Text("Vertices: %d", stats.vertices);
+        ImGui::Text("Draw calls: %d", stats.drawCalls);
+        ImGui::Text("Texture binds: %d", stats.textureBinds);
+        ImGui::Text("Uploaded: %.1f KB", stats.bytesUploaded / 1024.0f);
+        if (mode == RenderMode::Chunked)
+            ImGui::Text("Chunks: %d (rebuilt %d, pending %d)", stats.chunks, stats.chunksRebuilt, stats.chunksPending);
+
+        ImGui::Text("Textures: %d/%d resident", textures.resident, textures.total);
+        ImGui::Text("First frame: %.0f ms", textures.firstFrameMs);
+        if (textures.fullyLoadedMs > 0.0) {
+            ImGui::Text("Fully loaded: %.0f ms", textures.fullyLoadedMs);
+        }
+        else {
+            // Budget only matters while textures are still streaming in
+            int uploadKB = static_cast<int>(streaming.maxUploadBytes / 1024);
+            if (ImGui::SliderInt("Upload KB/frame", &uploadKB, 0, 16384, uploadKB == 0 ? "No limit" : "%d"))
+                streaming.maxUploadBytes = static_cast<size_t>(uploadKB) * 1024;
+            ImGui::SliderFloat("Upload ms/frame", &streaming.maxUploadMs, 0.0f, 16.0f, streaming.maxUploadMs == 0.0f ? "No limit" : "%.1f");
+        }
+
+        if (streaming.residencyBudgetBytes > 0) {
+            const AssetManager::ResidencyStats& residency = AssetManager::GetResidencyStats();
+            int requests = residency.hits + residency.misses;
+            ImGui::Text("Resident: %.1f / %.1f MB", residency.residentBytes / (1024.0f * 1024.0f),
+                residency.budgetBytes / (1024.0f * 1024.0f));
+            ImGui::Text("Hits: %d  Misses: %d (%.1f%% hit)", residency.hits, residency.misses,
+                requests > 0 ? 100.0f * residency.hits / requests : 0.0f);
+            ImGui::Text("Evictions: %d", residency.evictions);
+        }
+        ImGui::Separator();
+    }
+};
@@ -7,9 +7,11 @@ void Editor::handleEntityPlacement() {
 
     glm::vec2 pos = getMouseWorldPosition();
 
-    // Snap to grid
-    float snappedX = std::floor(pos.x / cellWidth) * cellWidth + cellWidth * 0.5f;
-    float snappedY = std::floor(pos.y / cellHeight) * cellHeight + cellHeight * 0.5f;
+    // Snap to grid: everything below works on the integer cell, one lookup per click
+    syncCellSize();
+    CellCoord cell = m_tileLayers.cellAt(pos.x, pos.y);
+    float snappedX, snappedY;
+    m_tileLayers.cellCentre(cell, snappedX, snappedY);
 
     // --- Edge detection ---
     static bool leftWasPressed = false;
@@ -19,44 +21,30 @@ void Editor::handleEntityPlacement() {
     bool rightPressed = glfwGetMouseButton(m_window.getHandle(), GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
 
     // LEFT CLICK — place entity
-    if (leftPressed) {
+    // Prevent duplicates only on SAME LAYER, and stay inside the map if it is bounded
+    if (leftPressed && currentScene.grid.contains(cell.x, cell.y) && !m_tileLayers.occupied(placementLayer, cell)) {
         Entity entity;
         entity.type = selectedType;
         entity.x = snappedX;
         entity.y = snappedY;
         entity.layer = placementLayer;
 
-        // Prevent duplicates only on SAME LAYER
-        bool alreadyPlaced = false;
-        for (auto& existing : currentScene.entities) {
-            if (existing.layer == entity.layer &&   
-                std::abs(existing.x - entity.x) < 0.1f &&
-                std::abs(existing.y - entity.y) < 0.1f)
-            {
-                alreadyPlaced = true;
-                break;
-            }
-        }
-
-        if (!alreadyPlaced) {
-            currentScene.entities.push_back(entity);
-            entitiesNeedSorting = true;
-            std::cout << "Placed entity: " << entity.type
-                << " at (" << entity.x << ", " << entity.y << ")\n";
-        }
+        entity.handle = currentScene.entities.create(entity);
+        onTileAdded(entity);
+        std::cout << "Placed entity: " << AssetRegistry::Name(entity.type)
+            << " at (" << entity.x << ", " << entity.y << ")\n";
     }
 
-    //  RIGHT CLICK — remove entity
-    if (rightPressed) {
-        for (auto it = currentScene.entities.begin(); it != currentScene.entities.end(); ++it) {
-            if (std::abs(it->x - snappedX) < cellWidth * 0.5f &&
-                std::abs(it->y - snappedY) < cellHeight * 0.5f) {
-                std::cout << "Removed entity: " << it->type
-                    << " at (" << it->x << ", " << it->y << ")\n";
-                currentScene.entities.erase(it);
-                entitiesNeedSorting = true; // Mark for sorting
-                break;
-            }
+    //  RIGHT CLICK — remove entity (topmost layer in the cell)
+    int layer;
+    if (rightPressed && m_tileLayers.topLayerAt(cell, layer)) {
+        Entity removed;
+        EntityHandle handle = currentScene.entities.handleFor(m_tileLayers.entityAt(layer, cell));
+        if (currentScene.entities.get(handle, removed)) {
+            std::cout << "Removed entity: " << AssetRegistry::Name(removed.type)
+                << " at (" << removed.x << ", " << removed.y << ")\n";
+            onTileRemoved(removed);
+            currentScene.entities.destroy(handle);
         }
     }
 }
@@ -74,44 +62,9 @@ void Editor::processInput() {
 }
 
 glm::vec2 Editor::getMouseWorldPosition() {
-    // Get current window size (updated each frame in run loop)
-    int currentWidth, currentHeight;
-    glfwGetWindowSize(m_window.getHandle(), &currentWidth, &currentHeight);
-
     double mouseX, mouseY;
     glfwGetCursorPos(m_window.getHandle(), &mouseX, &mouseY);
 
-    // Viewport dimensions (grid area, excluding left panel)
-    int viewportWidth = currentWidth - kLeftPanelWidth;
-    int viewportHeight = currentHeight;
-
-    // Convert mouse position to viewport coordinates
-    float viewX = static_cast<float>(mouseX) - kLeftPanelWidth;
-    float viewY = static_cast<float>(mouseY);
-
-    // Flip Y axis (OpenGL Y=0 is at bottom, screen Y=0 is at top)
-    viewY = viewportHeight - viewY;
-
-    // Normalize to [-1, 1] range in viewport space
-    float normalizedX = (viewX / viewportWidth) * 2.0f - 1.0f;
-    float normalizedY = (viewY / viewportHeight) * 2.0f - 1.0f;
-
-    // Get camera properties
-    glm::vec2 camPos = m_camera.getPosition();
-    float zoom = m_camera.getZoom();
-
-    // Match camera projection calculation exactly
-    // Camera uses virtual size (default 1280x720) and aspect ratio
-    float virtualWidth = 1280.0f;  // Match camera's m_virtualWidth
-    float virtualHeight = 720.0f;   // Match camera's m_virtualHeight
-    float aspect = static_cast<float>(viewportWidth) / static_cast<float>(viewportHeight);
-
-    float halfHeight = (virtualHeight * 0.5f) / zoom;
-    float halfWidth = halfHeight * aspect;
-
-    // Convert normalized coordinates to world space
-    float worldX = camPos.x + normalizedX * halfWidth;
-    float worldY = camPos.y + normalizedY * halfHeight;
-
-    return { worldX, worldY };
+    // Camera knows its viewport (right of the left panel), zoom, aspect and virtual size
+    return m_camera.screenToWorld(static_cast<float>(mouseX), static_cast<float>(mouseY));
 }
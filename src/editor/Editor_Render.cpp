@@ -1,124 +1,188 @@
 ﻿#include "Editor.h"
 #include "AssetManager.h"
+#include "Profiler.h"
 
 void Editor::drawInfiniteGrid() {
-    // Don't update camera virtual size here - it causes zoom when editing red square
-    // Camera virtual size is set when loading scenes, not during editing
-    m_camera.resize(windowWidth - kLeftPanelWidth, windowHeight);
-    glm::mat4 proj = m_camera.getProjection();
-
-    // Use shader and cached uniform
+    // One quad over the viewport; grid.frag derives the lines (and their zoom fade)
+    // from world coordinates, so cost doesn't depend on zoom or cell size.
+    // View rect and viewport come from the Camera block.
     m_gridShader.use();
-    glUniformMatrix4fv(uProjectionLoc, 1, GL_FALSE, glm::value_ptr(proj));
-
-    glm::vec2 camPos = m_camera.getPosition();
-    float zoom = m_camera.getZoom();
-
-    float halfW = (windowWidth - kLeftPanelWidth) * 0.5f / zoom;
-    float halfH = windowHeight * 0.5f / zoom;
-
-    float left = camPos.x - halfW * 2.0f;
-    float right = camPos.x + halfW * 2.0f;
-    float bottom = camPos.y - halfH * 2.0f;
-    float top = camPos.y + halfH * 2.0f;
-
-    float spacingX = cellWidth;
-    float spacingY = cellHeight;
-
-    // Use cached vector
-    gridVertices.clear();
-    gridVertices.reserve(20000);
-
-    // Vertical lines
-    float startX = std::floor(left / spacingX) * spacingX;
-    for (float x = startX; x <= right; x += spacingX) {
-        gridVertices.push_back(x); gridVertices.push_back(bottom);
-        gridVertices.push_back(x); gridVertices.push_back(top);
-    }
-
-    // Horizontal lines
-    float startY = std::floor(bottom / spacingY) * spacingY;
-    for (float y = startY; y <= top; y += spacingY) {
-        gridVertices.push_back(left);  gridVertices.push_back(y);
-        gridVertices.push_back(right); gridVertices.push_back(y);
-    }
-
+    glUniform2f(uGridCellSizeLoc, cellWidth, cellHeight);
+    glUniform3f(uGridColorLoc, 0.35f, 0.35f, 0.35f);
 
-    // Upload grid
     glBindVertexArray(gridVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, gridVBO);
-    glBufferData(GL_ARRAY_BUFFER,gridVertices.size() * sizeof(float), gridVertices.data(), GL_DYNAMIC_DRAW);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
 
-    glUniform3f(uGridColorLoc, 0.35f, 0.35f, 0.35f);
-    glDrawArrays(GL_LINES, 0, gridVertices.size() / 2);
-
-   
     // Draw red camera box
-    boxVertices.clear();
-    boxVertices.reserve(16);
-
-
     float halfViewW = gameViewWidth * 0.5f;
     float halfViewH = gameViewHeight * 0.5f;
 
-    boxVertices = {
+    float boxVertices[] = {
         -halfViewW, -halfViewH,  halfViewW, -halfViewH,
          halfViewW, -halfViewH,  halfViewW,  halfViewH,
          halfViewW,  halfViewH, -halfViewW,  halfViewH,
         -halfViewW,  halfViewH, -halfViewW, -halfViewH
     };
 
-    glBindVertexArray(boxVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, boxVBO);
-    glBufferData(GL_ARRAY_BUFFER, boxVertices.size() * sizeof(float), boxVertices.data(), GL_STATIC_DRAW);
+    constexpr size_t kStride = 2 * sizeof(float);
+    ptrdiff_t offset = m_streamBuffer.write(boxVertices, sizeof(boxVertices), kStride);
+    if (offset < 0) return;
 
-    glUniform3f(uGridColorLoc, 1.0f, 0.2f, 0.2f);
-    glDrawArrays(GL_LINES, 0, boxVertices.size() / 2);
+    glBindVertexArray(boxVAO);
+    m_lineShader.use();
+    glUniform3f(uLineColorLoc, 1.0f, 0.2f, 0.2f);
+    glDrawArrays(GL_LINES, static_cast<GLint>(offset / kStride), 8);
 }
 
 void Editor::drawEntities() {
-    glm::mat4 proj = m_camera.getProjection();
-
-    // Sort only when needed
-    if (entitiesNeedSorting) {
-        std::sort(currentScene.entities.begin(), currentScene.entities.end(),
-            [](const Entity& a, const Entity& b) { return a.layer < b.layer; });
-        entitiesNeedSorting = false;
+    syncCellSize();
+
+    updateVisibleTiles();
+    if (textureStreamSettings.residencyBudgetBytes > 0)
+        requestVisibleTextures();
+
+    // The instanced path only knows atlas regions, and the atlas is built once every texture
+    // is in (never, with on-demand residency)
+    RenderMode mode = renderMode;
+    if (mode == RenderMode::Instanced && AssetManager::GetAtlasRegionBuffer() == 0) mode = RenderMode::Batched;
+
+    switch (mode) {
+    case RenderMode::Batched:   drawEntitiesBatched();   break;
+    case RenderMode::Instanced: drawEntitiesInstanced(); break;
+    case RenderMode::Chunked:   drawEntitiesChunked();   break;
+    case RenderMode::Array:     drawEntitiesArray();     break;
     }
 
+    Profiler::SetCounter("Draw calls", m_renderStats.drawCalls);
+    Profiler::SetCounter("Texture binds", m_renderStats.textureBinds);
+    Profiler::SetCounter("Bytes uploaded", static_cast<double>(m_renderStats.bytesUploaded));
+    Profiler::SetCounter("Entities submitted", m_renderStats.sprites);
+}
+
+void Editor::drawEntitiesBatched() {
     m_spriteShader.use();
-    glBindVertexArray(m_quadVAO);
+    m_spriteBatch.begin();
+
+    const EntityStore& entities = currentScene.entities;
+    for (uint32_t tile : m_visibleTiles) {
+        Entity e = entities.entity(tile);
+        const AssetManager::TextureSlot& slot = AssetManager::GetTextureSlot(e.type);
+
+        // Prefer the atlas page so consecutive tiles share one texture
+        if (slot.region && slot.atlasPage != 0) {
+            const AtlasRegion* region = slot.region;
+            m_spriteBatch.submit(slot.atlasPage, e.layer, e.x, e.y, cellWidth, cellHeight,
+                glm::vec4(region->u0, region->v0, region->u1, region->v1));
+            continue;
+        }
 
-    GLuint lastTextureID = 0;   // Track last bound texture
+        GLuint texID = AssetManager::GetGPUHandleOrPlaceholder(e.type);
 
-    for (auto& e : currentScene.entities) {
-        // Get cached path or create and cache it
-        std::string& path = cachedTexturePaths[e.type];
-        if (path.empty()) {
-            path = "src/assets/" + e.type + ".png";
+        if (texID == 0) {
+            std::cerr << "Missing texture: " << AssetRegistry::Path(e.type) << std::endl;
+            continue;
         }
-        GLuint texID = AssetManager::GetGPUHandle(path);
 
-        if (texID == 0) {
-            std::cerr << "Missing texture: " << path << std::endl;
+        m_spriteBatch.submit(texID, e.layer, e.x, e.y, cellWidth, cellHeight);
+    }
+
+    // Sorted by layer/texture and drawn in a handful of draw calls
+    m_spriteBatch.end();
+    m_renderStats = m_spriteBatch.getStats();
+    m_renderStats.visible = static_cast<int>(m_visibleTiles.size());
+    m_renderStats.culled = static_cast<int>(m_spatialGrid.tileCount() - m_visibleTiles.size());
+}
+
+void Editor::drawEntitiesInstanced() {
+    // Re-uploads only when the visible set changed (edit or camera crossing a chunk)
+    m_instancedRenderer.update(currentScene.entities, m_visibleTiles, m_visibleSetVersion);
+    m_instancedRenderer.draw(cellWidth, cellHeight);
+    m_renderStats = m_instancedRenderer.getStats();
+    m_renderStats.visible = static_cast<int>(m_visibleTiles.size());
+    m_renderStats.culled = static_cast<int>(m_spatialGrid.tileCount() - m_visibleTiles.size());
+}
+
+void Editor::drawEntitiesChunked() {
+    m_spriteShader.use();
+    m_chunkCache.draw(m_spatialGrid, currentScene.entities, m_visibleRange);
+    m_renderStats = m_chunkCache.getStats();
+
+    // Meshes still being built on workers: keep frames coming so they appear as they land
+    if (m_chunkCache.pendingJobs() > 0)
+        m_framePacer.markDirty(FramePacer::DirtyScene);
+    m_renderStats.visible = static_cast<int>(m_visibleTiles.size());
+    m_renderStats.culled = static_cast<int>(m_spatialGrid.tileCount() - m_visibleTiles.size());
+}
+
+void Editor::drawEntitiesArray() {
+    m_arrayShader.use();
+
+    // Bound once; tiles in the array are told apart by their layer attribute, not a bind
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, AssetManager::GetTextureArrayHandle());
+    glActiveTexture(GL_TEXTURE0);
+
+    m_spriteBatch.begin();
+
+    const EntityStore& entities = currentScene.entities;
+    for (uint32_t tile : m_visibleTiles) {
+        Entity e = entities.entity(tile);
+        int textureLayer = AssetManager::GetTextureSlot(e.type).arrayLayer;
+        if (textureLayer >= 0) {
+            m_spriteBatch.submit(0, e.layer, e.x, e.y, cellWidth, cellHeight,
+                glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), static_cast<float>(textureLayer));
             continue;
         }
 
-        // Only bind texture when it changes
-        if (texID != lastTextureID) {
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, texID);
-            lastTextureID = texID;
+        // Odd-sized texture: regular single texture
+        GLuint texID = AssetManager::GetGPUHandleOrPlaceholder(e.type);
+        if (texID == 0) {
+            std::cerr << "Missing texture: " << AssetRegistry::Path(e.type) << std::endl;
+            continue;
         }
+        m_spriteBatch.submit(texID, e.layer, e.x, e.y, cellWidth, cellHeight);
+    }
 
-        float z = e.layer * 0.01f;
+    m_spriteBatch.end();
+    m_renderStats = m_spriteBatch.getStats();
+    m_renderStats.textureBinds++; // The array itself
+    m_renderStats.visible = static_cast<int>(m_visibleTiles.size());
+    m_renderStats.culled = static_cast<int>(m_spatialGrid.tileCount() - m_visibleTiles.size());
+}
 
-        glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(e.x, e.y, z));
-        model = glm::scale(model, glm::vec3(cellWidth, cellHeight, 1.0f));
-        glm::mat4 mvp = proj * model;
+// Marks every texture on screen as used this frame (and loads the missing ones). The
+// distinct assets are only regathered when the visible set changes.
+void Editor::requestVisibleTextures() {
+    if (m_visibleTexturesVersion != m_visibleSetVersion) {
+        std::vector<bool> seen(AssetRegistry::Count());
+        m_visibleTextureIds.clear();
+        const EntityStore& entities = currentScene.entities;
+        for (uint32_t tile : m_visibleTiles) {
+            AssetId type = entities.entity(tile).type;
+            if (type < seen.size() && !seen[type]) {
+                seen[type] = true;
+                m_visibleTextureIds.push_back(type);
+            }
+        }
+        m_visibleTexturesVersion = m_visibleSetVersion;
+    }
 
-        glUniformMatrix4fv(uMVPLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+    for (AssetId asset : m_visibleTextureIds) {
+        AssetManager::RequestTexture(asset);
     }
 }
 
+void Editor::updateVisibleTiles() {
+    // Only chunks overlapping the camera are walked; the rest of the map is never touched
+    ChunkRange range = m_spatialGrid.rangeFor(m_camera.getVisibleRect());
+    if (range == m_visibleRange && m_visibleRevision == sceneRevision) return;
+
+    m_visibleTiles.clear();
+    m_spatialGrid.forEachChunk(range, [&](int64_t, const std::vector<uint32_t>& tiles) {
+        m_visibleTiles.insert(m_visibleTiles.end(), tiles.begin(), tiles.end());
+    });
+
+    m_visibleRange = range;
+    m_visibleRevision = sceneRevision;
+    m_visibleSetVersion++;
+}
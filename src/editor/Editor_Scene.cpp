@@ -1,5 +1,6 @@
 ﻿#include "Editor.h"
 #include "SceneSerializer.h"
+#include "AssetManager.h"
 
 void Editor::newScene(const std::string& name) {
     currentScene.name = name;
@@ -7,7 +8,7 @@ void Editor::newScene(const std::string& name) {
     currentScene.entities.clear();
     currentScene.gameViewWidth = gameViewWidth;   // Initialize from editor
     currentScene.gameViewHeight = gameViewHeight;  // Initialize from editor
-    entitiesNeedSorting = false; // No need to sort empty list
+    onSceneReplaced();
 }
 
 void Editor::saveScene(const std::string& path) {
@@ -49,8 +50,47 @@ void Editor::loadScene(const std::string& path) {
     // Update camera virtual size when loading scene (not during editing)
     m_camera.setVirtualSize(gameViewWidth, gameViewHeight);
 
-    entitiesNeedSorting = true;
-    cachedTexturePaths.clear();
+    onSceneReplaced();
 
     std::cout << "Loaded scene: " << currentScene.name << " (" << path << ")\n";
 }
+
+// Keeps every derived structure (spatial grid, chunk meshes, scene revision) in sync with
+// a single tile edit. Only the touched chunk is invalidated; draw order is decided by the
+// renderers' RenderQueues, so the entity store is free to move rows and nothing gets re-sorted.
+void Editor::onTileAdded(const Entity& entity) {
+    m_tileLayers.place(entity.layer, m_tileLayers.cellAt(entity.x, entity.y), entity.type, entity.handle.index);
+    int64_t key = m_spatialGrid.add(entity);
+    m_chunkCache.invalidate(key);
+    sceneRevision++;
+    m_framePacer.markDirty(FramePacer::DirtyScene);
+}
+
+void Editor::onTileRemoved(const Entity& entity) {
+    m_tileLayers.remove(entity.layer, m_tileLayers.cellAt(entity.x, entity.y), entity.handle.index);
+    int64_t key;
+    if (m_spatialGrid.remove(entity, key))
+        m_chunkCache.invalidate(key);
+    sceneRevision++;
+    m_framePacer.markDirty(FramePacer::DirtyScene);
+}
+
+void Editor::onSceneReplaced() {
+    m_spatialGrid.rebuild(currentScene.entities);
+    m_tileLayers.rebuild(currentScene.entities);
+    m_chunkCache.clear();
+    sceneRevision++;
+    m_framePacer.markDirty(FramePacer::DirtyScene);
+}
+
+// Chunk bounds and cell coordinates follow the grid, so a cell size change re-buckets everything
+void Editor::syncCellSize() {
+    bool gridChanged = m_spatialGrid.setCellSize(cellWidth, cellHeight);
+    bool cellsChanged = m_tileLayers.setCellSize(cellWidth, cellHeight);
+    if (!gridChanged && !cellsChanged) return;
+
+    m_spatialGrid.rebuild(currentScene.entities);
+    m_tileLayers.rebuild(currentScene.entities);
+    m_chunkCache.clear();
+    sceneRevision++;
+}
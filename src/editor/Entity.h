@@ -1,9 +1,61 @@
 ﻿#pragma once
-#include <string>
+#include "AssetRegistry.h"
+#include <cstdint>
 
+/**
+ * EntityHandle: Stable reference to an entity in an EntityStore. The generation changes
+ * when the entity is destroyed, so a handle kept past that is rejected instead of
+ * silently pointing at whatever reuses the slot.
+ */
+struct EntityHandle {
+    static constexpr uint32_t kInvalidIndex = 0xffffffffu;
+
+    uint32_t index = kInvalidIndex;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != kInvalidIndex; } // Set at all, not necessarily alive
+    bool operator==(const EntityHandle& o) const { return index == o.index && generation == o.generation; }
+    bool operator!=(const EntityHandle& o) const { return !(*this == o); }
+};
+
+// Optional components, one bit each; an entity's mask picks its archetype in the EntityStore
+enum ComponentFlags : uint32_t {
+    ComponentNone = 0,
+    ComponentCollision = 1u << 0,
+    ComponentAnimation = 1u << 1,
+    ComponentTint = 1u << 2,
+    ComponentAll = ComponentCollision | ComponentAnimation | ComponentTint
+};
+
+struct CollisionComponent {
+    float width = 0.0f;  // Box centred on the entity, world units; 0 means the grid cell
+    float height = 0.0f;
+    bool solid = true;   // false: trigger only
+};
+
+// Frames are laid out left to right in the entity's texture
+struct AnimationComponent {
+    int frameCount = 1;
+    float framesPerSecond = 8.0f;
+    float startTime = 0.0f; // Offset in seconds, so neighbours don't animate in lockstep
+};
+
+struct TintComponent {
+    uint32_t rgba = 0xffffffffu; // 0xRRGGBBAA, multiplied into the texture colour
+};
+
+// Values for the components flagged in `mask`; the rest are ignored
+struct EntityComponents {
+    uint32_t mask = ComponentNone;
+    CollisionComponent collision;
+    AnimationComponent animation;
+    TintComponent tint;
+};
+
+// One entity's hot fields, copied out of (or into) an EntityStore row; a value, not storage
 struct Entity {
-    int id;           
-    std::string type = "";
+    EntityHandle handle;     // Set by EntityStore::create; invalid until the entity is stored
+    AssetId type = kNoAsset; // Saved by name, see AssetRegistry::Name
     float x = 0.0f;
     float y = 0.0f;
     int layer = 0;
@@ -0,0 +1,196 @@
+#include "EntityStore.h"
+
+namespace {
+    template<typename T>
+    void swapRemove(std::vector<T>& column, uint32_t row) {
+        if (column.empty()) return; // Component this archetype doesn't have
+        column[row] = column.back();
+        column.pop_back();
+    }
+}
+
+EntityHandle EntityStore::create(const Entity& entity, const EntityComponents& components) {
+    EntityHandle handle;
+    if (!m_freeSlots.empty()) {
+        handle.index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }
+    else {
+        handle.index = static_cast<uint32_t>(m_slots.size());
+        m_slots.emplace_back();
+    }
+    handle.generation = m_slots[handle.index].generation;
+
+    uint32_t archetype = archetypeFor(components.mask & ComponentAll);
+    m_slots[handle.index].set(archetype, appendRow(archetype, entity, components, handle.index));
+    m_size++;
+    return handle;
+}
+
+bool EntityStore::destroy(EntityHandle handle) {
+    if (!slotFor(handle)) return false;
+
+    Slot& slot = m_slots[handle.index];
+    removeRow(slot.archetype(), slot.row());
+    slot.generation++; // Every handle to it is stale from here on
+    m_freeSlots.push_back(handle.index);
+    m_size--;
+    return true;
+}
+
+bool EntityStore::alive(EntityHandle handle) const {
+    return slotFor(handle) != nullptr;
+}
+
+void EntityStore::clear() {
+    for (Archetype& archetype : m_archetypes) {
+        archetype.x.clear();
+        archetype.y.clear();
+        archetype.layer.clear();
+        archetype.type.clear();
+        archetype.index.clear();
+        archetype.collision.clear();
+        archetype.animation.clear();
+        archetype.tint.clear();
+    }
+
+    // Slots are kept with their generations bumped, so old handles can't match what reuses them
+    m_freeSlots.clear();
+    m_freeSlots.reserve(m_slots.size());
+    for (size_t i = m_slots.size(); i-- > 0;) {
+        m_slots[i].generation++;
+        m_freeSlots.push_back(static_cast<uint32_t>(i));
+    }
+    m_size = 0;
+}
+
+void EntityStore::reserve(size_t count) {
+    if (count > m_freeSlots.size()) m_slots.reserve(m_slots.size() + count - m_freeSlots.size());
+
+    Archetype& plain = m_archetypes[archetypeFor(ComponentNone)];
+    plain.x.reserve(count);
+    plain.y.reserve(count);
+    plain.layer.reserve(count);
+    plain.type.reserve(count);
+    plain.index.reserve(count);
+}
+
+bool EntityStore::get(EntityHandle handle, Entity& out) const {
+    const Slot* slot = slotFor(handle);
+    if (!slot) return false;
+    out = record(m_archetypes[slot->archetype()], slot->row(), handle.index);
+    return true;
+}
+
+bool EntityStore::set(EntityHandle handle, const Entity& entity) {
+    const Slot* slot = slotFor(handle);
+    if (!slot) return false;
+
+    Archetype& archetype = m_archetypes[slot->archetype()];
+    uint32_t row = slot->row();
+    archetype.x[row] = entity.x;
+    archetype.y[row] = entity.y;
+    archetype.layer[row] = entity.layer;
+    archetype.type[row] = entity.type;
+    return true;
+}
+
+bool EntityStore::getComponents(EntityHandle handle, EntityComponents& out) const {
+    const Slot* slot = slotFor(handle);
+    if (!slot) return false;
+
+    const Archetype& archetype = m_archetypes[slot->archetype()];
+    uint32_t row = slot->row();
+    out = EntityComponents();
+    out.mask = archetype.mask;
+    if (archetype.mask & ComponentCollision) out.collision = archetype.collision[row];
+    if (archetype.mask & ComponentAnimation) out.animation = archetype.animation[row];
+    if (archetype.mask & ComponentTint) out.tint = archetype.tint[row];
+    return true;
+}
+
+bool EntityStore::setComponents(EntityHandle handle, const EntityComponents& components) {
+    const Slot* found = slotFor(handle);
+    if (!found) return false;
+
+    uint32_t current = found->archetype();
+    uint32_t row = found->row();
+    uint32_t mask = components.mask & ComponentAll;
+    if (mask == m_archetypes[current].mask) {
+        Archetype& archetype = m_archetypes[current];
+        if (mask & ComponentCollision) archetype.collision[row] = components.collision;
+        if (mask & ComponentAnimation) archetype.animation[row] = components.animation;
+        if (mask & ComponentTint) archetype.tint[row] = components.tint;
+        return true;
+    }
+
+    // Different mask: copy the hot fields over to the matching archetype, then drop the old row
+    Entity entity = record(m_archetypes[current], row, handle.index);
+    uint32_t target = archetypeFor(mask); // May grow m_archetypes, so no references held across it
+    uint32_t targetRow = appendRow(target, entity, components, handle.index);
+    removeRow(current, row);
+    m_slots[handle.index].set(target, targetRow);
+    return true;
+}
+
+CollisionComponent* EntityStore::collision(EntityHandle handle) {
+    const Slot* slot = slotFor(handle);
+    if (!slot || !(m_archetypes[slot->archetype()].mask & ComponentCollision)) return nullptr;
+    return &m_archetypes[slot->archetype()].collision[slot->row()];
+}
+
+AnimationComponent* EntityStore::animation(EntityHandle handle) {
+    const Slot* slot = slotFor(handle);
+    if (!slot || !(m_archetypes[slot->archetype()].mask & ComponentAnimation)) return nullptr;
+    return &m_archetypes[slot->archetype()].animation[slot->row()];
+}
+
+TintComponent* EntityStore::tint(EntityHandle handle) {
+    const Slot* slot = slotFor(handle);
+    if (!slot || !(m_archetypes[slot->archetype()].mask & ComponentTint)) return nullptr;
+    return &m_archetypes[slot->archetype()].tint[slot->row()];
+}
+
+const EntityStore::Slot* EntityStore::slotFor(EntityHandle handle) const {
+    if (handle.index >= m_slots.size()) return nullptr;
+    const Slot& slot = m_slots[handle.index];
+    return slot.generation == handle.generation ? &slot : nullptr;
+}
+
+uint32_t EntityStore::archetypeFor(uint32_t mask) {
+    // Three components make at most eight archetypes, a scan beats a map
+    for (size_t i = 0; i < m_archetypes.size(); i++) {
+        if (m_archetypes[i].mask == mask) return static_cast<uint32_t>(i);
+    }
+    m_archetypes.emplace_back();
+    m_archetypes.back().mask = mask;
+    return static_cast<uint32_t>(m_archetypes.size() - 1);
+}
+
+uint32_t EntityStore::appendRow(uint32_t archetypeIndex, const Entity& entity, const EntityComponents& components, uint32_t index) {
+    Archetype& archetype = m_archetypes[archetypeIndex];
+    archetype.x.push_back(entity.x);
+    archetype.y.push_back(entity.y);
+    archetype.layer.push_back(entity.layer);
+    archetype.type.push_back(entity.type);
+    archetype.index.push_back(index);
+    if (archetype.mask & ComponentCollision) archetype.collision.push_back(components.collision);
+    if (archetype.mask & ComponentAnimation) archetype.animation.push_back(components.animation);
+    if (archetype.mask & ComponentTint) archetype.tint.push_back(components.tint);
+    return static_cast<uint32_t>(archetype.size() - 1);
+}
+
+void EntityStore::removeRow(uint32_t archetypeIndex, uint32_t row) {
+    Archetype& archetype = m_archetypes[archetypeIndex];
+    uint32_t last = static_cast<uint32_t>(archetype.size() - 1);
+    if (row != last) m_slots[archetype.index[last]].setRow(row);
+
+    swapRemove(archetype.x, row);
+    swapRemove(archetype.y, row);
+    swapRemove(archetype.layer, row);
+    swapRemove(archetype.type, row);
+    swapRemove(archetype.index, row);
+    swapRemove(archetype.collision, row);
+    swapRemove(archetype.animation, row);
+    swapRemove(archetype.tint, row);
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "Entity.h"
+
+/**
+ * EntityStore: The scene's entities as structure-of-arrays, grouped into archetypes by
+ * component mask. Every archetype keeps the hot fields (position, layer, asset) in
+ * contiguous columns, plus a column for each component in its mask and nothing for the
+ * rest: a plain tile is 20 bytes of columns and an 8-byte slot, and passes over positions
+ * touch only position memory. Entities are addressed by generational handles through a
+ * slot table; removal swaps the last row into the hole, so rows move but handles don't.
+ *
+ * The store is the only copy of the scene. SpatialGrid and TileLayers keep entity indices
+ * (a handle's index, always alive there since they are updated with every edit) and the
+ * renderers read the columns back through entity().
+ */
+class EntityStore {
+public:
+    struct Archetype {
+        uint32_t mask = ComponentNone;
+
+        // Hot columns, one row per entity
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<int> layer;
+        std::vector<AssetId> type;
+        std::vector<uint32_t> index; // Row -> entity index, to fix up the slot of a moved row
+
+        // Only the columns in `mask` are filled, the others stay empty
+        std::vector<CollisionComponent> collision;
+        std::vector<AnimationComponent> animation;
+        std::vector<TintComponent> tint;
+
+        size_t size() const { return index.size(); }
+    };
+
+    /**
+     * Create: Stores `entity` (its handle is ignored) with the components flagged in
+     * `components.mask` and returns its handle.
+     */
+    EntityHandle create(const Entity& entity, const EntityComponents& components = {});
+    bool destroy(EntityHandle handle); // false if the handle is stale
+    bool alive(EntityHandle handle) const;
+
+    /**
+     * Entity: Hot fields of the live entity with this index, read straight from its row.
+     * Only for indices known to be alive (the spatial indexes); inline for per-tile loops.
+     */
+    Entity entity(uint32_t index) const {
+        const Slot& slot = m_slots[index];
+        const Archetype& archetype = m_archetypes[slot.archetype()];
+        return record(archetype, slot.row(), index);
+    }
+    EntityHandle handleFor(uint32_t index) const { return { index, m_slots[index].generation }; }
+
+    // Removes every entity; handles from before stay stale even once slots are reused
+    void clear();
+    // Room for `count` entities without components, the common case when loading a map
+    void reserve(size_t count);
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * Get / set: Copy an entity's hot fields out of or into its row (set ignores the
+     * record's handle). Both return false if the handle is stale.
+     */
+    bool get(EntityHandle handle, Entity& out) const;
+    bool set(EntityHandle handle, const Entity& entity);
+
+    /**
+     * Components: get fills `out` with the entity's mask and values; set replaces them,
+     * moving the entity to another archetype if the mask changes.
+     */
+    bool getComponents(EntityHandle handle, EntityComponents& out) const;
+    bool setComponents(EntityHandle handle, const EntityComponents& components);
+
+    // Direct access to one component; nullptr if the entity is stale or lacks it
+    CollisionComponent* collision(EntityHandle handle);
+    AnimationComponent* animation(EntityHandle handle);
+    TintComponent* tint(EntityHandle handle);
+
+    /**
+     * Views: forEach calls fn(const Entity&) for every entity, archetype by archetype.
+     * forEachArchetype hands out whole archetypes for column passes; values may be
+     * written, but rows must not be added or removed through it.
+     */
+    template<typename Fn>
+    void forEach(Fn&& fn) const {
+        for (const Archetype& archetype : m_archetypes) {
+            for (size_t row = 0; row < archetype.size(); row++)
+                fn(record(archetype, row, archetype.index[row]));
+        }
+    }
+
+    template<typename Fn>
+    void forEachArchetype(Fn&& fn) {
+        for (Archetype& archetype : m_archetypes) fn(archetype);
+    }
+
+    const std::vector<Archetype>& archetypes() const { return m_archetypes; }
+
+    // Handle of the first entity matching pred(const Entity&), or an invalid handle
+    template<typename Pred>
+    EntityHandle find(Pred&& pred) const {
+        for (const Archetype& archetype : m_archetypes) {
+            for (size_t row = 0; row < archetype.size(); row++) {
+                Entity e = record(archetype, row, archetype.index[row]);
+                if (pred(e)) return e.handle;
+            }
+        }
+        return {};
+    }
+
+private:
+    // Archetype in the top bits of `location` (eight fit), row in the rest
+    struct Slot {
+        static constexpr uint32_t kRowBits = 29;
+        static constexpr uint32_t kRowMask = (1u << kRowBits) - 1;
+
+        uint32_t generation = 0;
+        uint32_t location = 0;
+
+        uint32_t archetype() const { return location >> kRowBits; }
+        uint32_t row() const { return location & kRowMask; }
+        void set(uint32_t archetype, uint32_t row) { location = (archetype << kRowBits) | row; }
+        void setRow(uint32_t row) { set(archetype(), row); }
+    };
+
+    Entity record(const Archetype& archetype, size_t row, uint32_t index) const {
+        Entity e;
+        e.handle = { index, m_slots[index].generation };
+        e.type = archetype.type[row];
+        e.x = archetype.x[row];
+        e.y = archetype.y[row];
+        e.layer = archetype.layer[row];
+        return e;
+    }
+
+    const Slot* slotFor(EntityHandle handle) const;
+    uint32_t archetypeFor(uint32_t mask);
+    uint32_t appendRow(uint32_t archetype, const Entity& entity, const EntityComponents& components, uint32_t index);
+    void removeRow(uint32_t archetype, uint32_t row);
+
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    std::vector<Archetype> m_archetypes; // At most one per mask, created on first use
+    size_t m_size = 0;
+};
@@ -0,0 +1,139 @@
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "FramePacer.h"
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+static constexpr int kUISettleFrames = 3;
+static constexpr double kStatsWindowSeconds = 0.5;
+
+// CPU time of the whole process (all threads), in seconds
+static double processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user))
+        return 0.0;
+    ULARGE_INTEGER k, u;
+    k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+    u.LowPart = user.dwLowDateTime;   u.HighPart = user.dwHighDateTime;
+    return (k.QuadPart + u.QuadPart) * 1e-7; // 100ns units
+#else
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+        (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1e-6;
+#endif
+}
+
+FramePacer::FramePacer(FrameSettings& settings, FrameStats& stats)
+    : m_settings(settings), m_stats(stats)
+{
+    m_windowStart = m_lastFrameEnd = m_nextDeadline = Clock::now();
+    m_windowCpuStart = processCpuSeconds();
+}
+
+void FramePacer::markDirty(unsigned int flags) {
+    if (flags == DirtyNone) return;
+    m_pendingDirty |= flags;
+    m_pendingFrames = std::max(m_pendingFrames, (flags & DirtyUI) ? kUISettleFrames : 1);
+}
+
+void FramePacer::waitForEvents(const Window& window) {
+    m_heartbeat = false;
+    if (m_settings.mode == LoopMode::Continuous || m_pendingFrames > 0) {
+        window.pollEvents();
+        return;
+    }
+
+    // Callbacks fired during the wait mark us dirty; if none did, the timeout expired
+    window.waitEvents(m_settings.idleTimeout);
+    if (m_pendingFrames == 0)
+        m_heartbeat = true;
+}
+
+void FramePacer::beginFrame() {
+    if (m_appliedVsync != static_cast<int>(m_settings.vsync)) {
+        glfwSwapInterval(m_settings.vsync ? 1 : 0);
+        m_appliedVsync = static_cast<int>(m_settings.vsync);
+    }
+    m_frameStart = Clock::now();
+}
+
+void FramePacer::endFrame() {
+    Clock::time_point workEnd = Clock::now();
+    m_windowWorkMs += std::chrono::duration<double, std::milli>(workEnd - m_frameStart).count();
+
+    if (m_settings.fpsCap > 0) {
+        auto period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_settings.fpsCap));
+        m_nextDeadline += period;
+        // Coming back from idle (or a long hitch): restart the schedule instead of bursting to catch up
+        if (m_nextDeadline < workEnd)
+            m_nextDeadline = workEnd + period;
+        paceTo(m_nextDeadline);
+    }
+
+    Clock::time_point now = Clock::now();
+    // Only back-to-back active frames count towards jitter; an interval that spans an idle wait isn't jitter
+    bool active = m_settings.mode == LoopMode::Continuous || (!m_heartbeat && m_pendingDirty != DirtyNone);
+    if (active && m_previousActive)
+        m_activeIntervals.push_back(std::chrono::duration<double, std::milli>(now - m_lastFrameEnd).count());
+    m_previousActive = active;
+    m_lastFrameEnd = now;
+
+    m_stats.lastDirty = m_pendingDirty;
+    if (m_pendingFrames > 0 && --m_pendingFrames == 0)
+        m_pendingDirty = DirtyNone;
+
+    m_windowFrames++;
+    if (m_heartbeat) m_windowIdleWakeups++;
+    updateStats(now);
+}
+
+void FramePacer::paceTo(Clock::time_point deadline) const {
+    // Sleep is only accurate to a scheduler tick, so stop early and spin the rest
+    auto margin = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(m_settings.spinMargin));
+    Clock::time_point now = Clock::now();
+    if (deadline - now > margin)
+        std::this_thread::sleep_for(deadline - now - margin);
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+void FramePacer::updateStats(Clock::time_point now) {
+    double elapsed = std::chrono::duration<double>(now - m_windowStart).count();
+    if (elapsed < kStatsWindowSeconds) return;
+
+    double cpu = processCpuSeconds();
+    m_stats.fps = static_cast<float>(m_windowFrames / elapsed);
+    m_stats.frameMs = static_cast<float>(m_windowWorkMs / m_windowFrames);
+    m_stats.cpuPercent = static_cast<float>((cpu - m_windowCpuStart) / elapsed * 100.0);
+    m_stats.idleWakeups = m_windowIdleWakeups;
+
+    if (m_activeIntervals.size() >= 2) {
+        double mean = 0.0;
+        for (double interval : m_activeIntervals) mean += interval;
+        mean /= m_activeIntervals.size();
+        double variance = 0.0;
+        for (double interval : m_activeIntervals) variance += (interval - mean) * (interval - mean);
+        m_stats.jitterMs = static_cast<float>(std::sqrt(variance / m_activeIntervals.size()));
+    }
+    else {
+        m_stats.jitterMs = 0.0f;
+    }
+
+    m_windowStart = now;
+    m_windowCpuStart = cpu;
+    m_windowFrames = 0;
+    m_windowIdleWakeups = 0;
+    m_windowWorkMs = 0.0;
+    m_activeIntervals.clear();
+}
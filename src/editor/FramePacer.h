@@ -0,0 +1,93 @@
+#pragma once
+#include <chrono>
+#include <vector>
+#include "../Window.h"
+
+// How Editor::run decides when to draw. Selectable at runtime from the Frame panel.
+enum class LoopMode {
+    Continuous = 0, // Poll and redraw every iteration (old behaviour)
+    OnDemand = 1,   // Sleep in glfwWaitEventsTimeout until something is dirty
+};
+
+struct FrameSettings {
+    LoopMode mode = LoopMode::OnDemand;
+    int fpsCap = 60;               // 0 = uncapped
+    bool vsync = false;
+    float idleTimeout = 0.5f;      // Seconds between heartbeat frames while idle
+    float spinMargin = 2.0f;       // Milliseconds before a capped deadline to stop sleeping and spin
+};
+
+// Refreshed a few times per second by FramePacer
+struct FrameStats {
+    float fps = 0.0f;              // Frames actually rendered per second
+    float frameMs = 0.0f;          // Average work per frame, excluding waits
+    float jitterMs = 0.0f;         // Std. deviation of frame intervals while active
+    float cpuPercent = 0.0f;       // Process CPU time / wall time (100 = one core)
+    int idleWakeups = 0;           // Heartbeat frames in the last window
+    unsigned int lastDirty = 0;    // FramePacer::Dirty flags that caused the last frame
+};
+
+/**
+ * FramePacer: Owns the wait/draw/pace decisions of the editor loop. Input callbacks and
+ * edits mark the scene, camera or UI dirty; in OnDemand mode the loop sleeps in the OS
+ * until an event arrives or the idle heartbeat expires, then draws until the dirty state
+ * has settled. An optional fps cap sleeps most of the remaining frame time and spins the
+ * last couple of milliseconds, since OS sleeps overshoot by about a scheduler tick.
+ */
+class FramePacer {
+public:
+    enum Dirty : unsigned int {
+        DirtyNone = 0,
+        DirtyScene = 1 << 0,
+        DirtyCamera = 1 << 1,
+        DirtyUI = 1 << 2,
+    };
+
+    FramePacer(FrameSettings& settings, FrameStats& stats);
+
+    /**
+     * Mark dirty: Requests frames. UI changes ask for a few so ImGui can settle its
+     * layout and hover state; scene and camera changes need one.
+     */
+    void markDirty(unsigned int flags);
+
+    /**
+     * Wait for events: Polls in Continuous mode or while frames are pending, otherwise
+     * blocks in the window's event wait until an event or the idle timeout.
+     */
+    void waitForEvents(const Window& window);
+
+    /**
+     * Begin / end frame: Bracket the frame's work. endFrame() consumes one pending frame,
+     * waits out the fps cap and updates the stats.
+     */
+    void beginFrame();
+    void endFrame();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    void paceTo(Clock::time_point deadline) const;
+    void updateStats(Clock::time_point now);
+
+    FrameSettings& m_settings;
+    FrameStats& m_stats;
+
+    int m_pendingFrames = 1;
+    unsigned int m_pendingDirty = DirtyUI;
+    bool m_heartbeat = false;
+    bool m_previousActive = false;
+    int m_appliedVsync = -1;
+
+    Clock::time_point m_frameStart;
+    Clock::time_point m_lastFrameEnd;
+    Clock::time_point m_nextDeadline;
+
+    // Rolling window the stats are computed from
+    Clock::time_point m_windowStart;
+    double m_windowCpuStart = 0.0;
+    int m_windowFrames = 0;
+    int m_windowIdleWakeups = 0;
+    double m_windowWorkMs = 0.0;
+    std::vector<double> m_activeIntervals;
+};
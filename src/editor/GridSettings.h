@@ -4,4 +4,9 @@
 struct GridSettings {
     float cellWidth, cellHeight;
     int rows, cols;
+    bool bounded = false; // Placement limited to cols x rows cells from the origin; unbounded otherwise
+
+    bool contains(int col, int row) const {
+        return !bounded || (col >= 0 && col < cols && row >= 0 && row < rows);
+    }
 };
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+// 64-bit FNV-1a. Used for cache keys (shader binaries, compressed textures), not security.
+constexpr uint64_t kFnv1aSeed = 1469598103934665603ull;
+
+inline uint64_t Fnv1a64(const void* data, size_t size, uint64_t hash = kFnv1aSeed) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
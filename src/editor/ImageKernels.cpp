@@ -0,0 +1,326 @@
+#include "ImageKernels.h"
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#define IMAGE_KERNELS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define AVX2_TARGET
+#else
+#define AVX2_TARGET __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+    // ---------------------------------------------------------------- Scalar reference
+
+    // round(c * a / 255) for c, a in 0..255, without a division
+    inline uint8_t mulDiv255(unsigned c, unsigned a) {
+        unsigned t = c * a + 128;
+        return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+    }
+
+    void expandScalar(const uint8_t* src, int channels, uint8_t* dst, size_t begin, size_t count) {
+        for (size_t i = begin; i < count; i++) {
+            const uint8_t* s = src + i * channels;
+            uint8_t* d = dst + i * 4;
+            switch (channels) {
+            case 1: d[0] = d[1] = d[2] = s[0]; d[3] = 255;  break;
+            case 2: d[0] = d[1] = d[2] = s[0]; d[3] = s[1]; break;
+            case 3: d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = 255; break;
+            default: std::memcpy(d, s, 4); break;
+            }
+        }
+    }
+
+    void premultiplyScalar(uint8_t* rgba, size_t begin, size_t count) {
+        for (size_t i = begin; i < count; i++) {
+            uint8_t* p = rgba + i * 4;
+            p[0] = mulDiv255(p[0], p[3]);
+            p[1] = mulDiv255(p[1], p[3]);
+            p[2] = mulDiv255(p[2], p[3]);
+        }
+    }
+
+    // Output pixels [begin, outWidth) of one row; row0/row1 are the source rows to average
+    void downsampleRowScalar(const uint8_t* row0, const uint8_t* row1, int width, uint8_t* dst, int begin, int outWidth) {
+        for (int x = begin; x < outWidth; x++) {
+            int x0 = std::min(2 * x, width - 1) * 4;
+            int x1 = std::min(2 * x + 1, width - 1) * 4;
+            for (int c = 0; c < 4; c++) {
+                int sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                dst[x * 4 + c] = static_cast<uint8_t>((sum + 2) >> 2);
+            }
+        }
+    }
+
+#ifdef IMAGE_KERNELS_X86
+    // ---------------------------------------------------------------- SSE2 (every x64 CPU)
+
+    // Returns how many pixels it did; the scalar loop finishes the rest
+    size_t expandSSE2(const uint8_t* src, int channels, uint8_t* dst, size_t count) {
+        const __m128i opaque = _mm_set1_epi8(static_cast<char>(0xFF));
+        size_t i = 0;
+        if (channels == 1) {
+            for (; i + 16 <= count; i += 16) {
+                __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                __m128i gg = _mm_unpacklo_epi8(g, g);
+                __m128i ga = _mm_unpacklo_epi8(g, opaque);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi16(gg, ga));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_unpackhi_epi16(gg, ga));
+                gg = _mm_unpackhi_epi8(g, g);
+                ga = _mm_unpackhi_epi8(g, opaque);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 32), _mm_unpacklo_epi16(gg, ga));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 48), _mm_unpackhi_epi16(gg, ga));
+            }
+        }
+        else if (channels == 2) {
+            const __m128i greyMask = _mm_set1_epi16(0x00FF);
+            for (; i + 8 <= count; i += 8) {
+                __m128i ga = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+                __m128i g = _mm_and_si128(ga, greyMask);
+                __m128i gg = _mm_or_si128(g, _mm_slli_epi16(g, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4), _mm_unpacklo_epi16(gg, ga));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 4 + 16), _mm_unpackhi_epi16(gg, ga));
+            }
+        }
+        else if (channels == 4) {
+            std::memcpy(dst, src, count * 4);
+            i = count;
+        }
+        // RGB needs a byte shuffle SSE2 doesn't have: scalar, or the AVX2 path
+        return i;
+    }
+
+    // c * a in 16-bit lanes, then the same rounding as mulDiv255. The alpha lanes are
+    // multiplied by 255, which gives alpha back unchanged.
+    inline __m128i premultiply8x16(__m128i px, __m128i alphaLanes, __m128i rgbMask) {
+        __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm_or_si128(_mm_and_si128(a, rgbMask), alphaLanes);
+        __m128i t = _mm_add_epi16(_mm_mullo_epi16(px, a), _mm_set1_epi16(128));
+        return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+    }
+
+    size_t premultiplySSE2(uint8_t* rgba, size_t count) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rgbMask = _mm_set_epi16(0, -1, -1, -1, 0, -1, -1, -1);
+        const __m128i alphaLanes = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i* p = reinterpret_cast<__m128i*>(rgba + i * 4);
+            __m128i px = _mm_loadu_si128(p);
+            __m128i lo = premultiply8x16(_mm_unpacklo_epi8(px, zero), alphaLanes, rgbMask);
+            __m128i hi = premultiply8x16(_mm_unpackhi_epi8(px, zero), alphaLanes, rgbMask);
+            _mm_storeu_si128(p, _mm_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+
+    // 4 output pixels from 8 source pixels of each row. Needs width >= 2.
+    int downsampleRowSSE2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int outWidth) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i two = _mm_set1_epi16(2);
+        int x = 0;
+        for (; x + 4 <= outWidth; x += 4) {
+            __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8));
+            __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + x * 8 + 16));
+            __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8));
+            __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + x * 8 + 16));
+
+            // Vertical pairs in 16-bit lanes, two source pixels per register
+            __m128i s01 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero), _mm_unpacklo_epi8(b0, zero));
+            __m128i s23 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero), _mm_unpackhi_epi8(b0, zero));
+            __m128i s45 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero), _mm_unpacklo_epi8(b1, zero));
+            __m128i s67 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero), _mm_unpackhi_epi8(b1, zero));
+
+            // Horizontal pairs: add the upper pixel onto the lower one
+            __m128i o0 = _mm_add_epi16(s01, _mm_srli_si128(s01, 8));
+            __m128i o1 = _mm_add_epi16(s23, _mm_srli_si128(s23, 8));
+            __m128i o2 = _mm_add_epi16(s45, _mm_srli_si128(s45, 8));
+            __m128i o3 = _mm_add_epi16(s67, _mm_srli_si128(s67, 8));
+
+            __m128i lo = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(o0, o1), two), 2);
+            __m128i hi = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(o2, o3), two), 2);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(lo, hi));
+        }
+        return x;
+    }
+
+    // ---------------------------------------------------------------- AVX2 (runtime checked)
+
+    AVX2_TARGET size_t expandAVX2(const uint8_t* src, int channels, uint8_t* dst, size_t count) {
+        if (channels != 3) return expandSSE2(src, channels, dst, count); // Already bound by memory
+
+        // Four RGB pixels (12 bytes) per 128-bit lane, spread to RGBA with alpha or'ed in
+        const __m256i spread = _mm256_setr_epi8(
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+            0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+        const __m256i alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+        size_t i = 0;
+        // Each lane loads 16 bytes for its 12, so stop while 4 more bytes are still in bounds
+        for (; i + 10 <= count; i += 8) {
+            __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3));
+            __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 3 + 12));
+            __m256i rgb = _mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1);
+            __m256i rgba = _mm256_or_si256(_mm256_shuffle_epi8(rgb, spread), alpha);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 4), rgba);
+        }
+        return i;
+    }
+
+    AVX2_TARGET inline __m256i premultiply16x16(__m256i px, __m256i alphaLanes, __m256i rgbMask) {
+        __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        a = _mm256_or_si256(_mm256_and_si256(a, rgbMask), alphaLanes);
+        __m256i t = _mm256_add_epi16(_mm256_mullo_epi16(px, a), _mm256_set1_epi16(128));
+        return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+    }
+
+    AVX2_TARGET size_t premultiplyAVX2(uint8_t* rgba, size_t count) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i rgbMask = _mm256_set_epi16(0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1, 0, -1, -1, -1);
+        const __m256i alphaLanes = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i* p = reinterpret_cast<__m256i*>(rgba + i * 4);
+            __m256i px = _mm256_loadu_si256(p);
+            // unpack and pack both work per 128-bit lane, so the pixel order survives
+            __m256i lo = premultiply16x16(_mm256_unpacklo_epi8(px, zero), alphaLanes, rgbMask);
+            __m256i hi = premultiply16x16(_mm256_unpackhi_epi8(px, zero), alphaLanes, rgbMask);
+            _mm256_storeu_si256(p, _mm256_packus_epi16(lo, hi));
+        }
+        return i;
+    }
+
+    // 8 output pixels from 16 source pixels of each row. Needs width >= 2.
+    AVX2_TARGET int downsampleRowAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* dst, int outWidth) {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i two = _mm256_set1_epi16(2);
+        int x = 0;
+        for (; x + 8 <= outWidth; x += 8) {
+            __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8));
+            __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row0 + x * 8 + 32));
+            __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8));
+            __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row1 + x * 8 + 32));
+
+            // Same steps as the SSE2 version, in each 128-bit lane
+            __m256i sLo0 = _mm256_add_epi16(_mm256_unpacklo_epi8(a0, zero), _mm256_unpacklo_epi8(b0, zero));
+            __m256i sHi0 = _mm256_add_epi16(_mm256_unpackhi_epi8(a0, zero), _mm256_unpackhi_epi8(b0, zero));
+            __m256i sLo1 = _mm256_add_epi16(_mm256_unpacklo_epi8(a1, zero), _mm256_unpacklo_epi8(b1, zero));
+            __m256i sHi1 = _mm256_add_epi16(_mm256_unpackhi_epi8(a1, zero), _mm256_unpackhi_epi8(b1, zero));
+
+            __m256i oLo0 = _mm256_add_epi16(sLo0, _mm256_srli_si256(sLo0, 8));
+            __m256i oHi0 = _mm256_add_epi16(sHi0, _mm256_srli_si256(sHi0, 8));
+            __m256i oLo1 = _mm256_add_epi16(sLo1, _mm256_srli_si256(sLo1, 8));
+            __m256i oHi1 = _mm256_add_epi16(sHi1, _mm256_srli_si256(sHi1, 8));
+
+            __m256i first = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(oLo0, oHi0), two), 2);
+            __m256i second = _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(oLo1, oHi1), two), 2);
+
+            // Lanes come out as pixels 0-1, 4-5 | 2-3, 6-7: put the 64-bit pairs back in order
+            __m256i packed = _mm256_packus_epi16(first, second);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x * 4), _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+        }
+        return x;
+    }
+
+    bool cpuHasAVX2() {
+#ifdef _MSC_VER
+        int info[4];
+        __cpuid(info, 0);
+        if (info[0] < 7) return false;
+        __cpuid(info, 1);
+        bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+        if (!osSavesYmm) return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    }
+#endif
+
+    std::atomic<int> s_active{ -1 }; // -1: not chosen yet
+}
+
+ImageKernels::Isa ImageKernels::Supported() {
+#ifdef IMAGE_KERNELS_X86
+    static const Isa supported = cpuHasAVX2() ? Isa::AVX2 : Isa::SSE2;
+    return supported;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+ImageKernels::Isa ImageKernels::Active() {
+    int active = s_active.load(std::memory_order_relaxed);
+    return active < 0 ? Supported() : static_cast<Isa>(active);
+}
+
+void ImageKernels::SetActive(Isa isa) {
+    s_active.store(static_cast<int>(std::min(isa, Supported())), std::memory_order_relaxed);
+}
+
+const char* ImageKernels::IsaName(Isa isa) {
+    switch (isa) {
+    case Isa::SSE2: return "sse2";
+    case Isa::AVX2: return "avx2";
+    default:        return "scalar";
+    }
+}
+
+void ImageKernels::FlipVertical(const uint8_t* src, uint8_t* dst, size_t rowBytes, int rows) {
+    // Whole rows move, so this is memcpy's job; it already uses the widest loads there are
+    for (int y = 0; y < rows; y++) {
+        std::memcpy(dst + rowBytes * y, src + rowBytes * (rows - 1 - y), rowBytes);
+    }
+}
+
+void ImageKernels::ExpandToRGBA(const uint8_t* src, int channels, uint8_t* dst, size_t pixelCount) {
+    size_t done = 0;
+#ifdef IMAGE_KERNELS_X86
+    switch (Active()) {
+    case Isa::AVX2: done = expandAVX2(src, channels, dst, pixelCount); break;
+    case Isa::SSE2: done = expandSSE2(src, channels, dst, pixelCount); break;
+    default: break;
+    }
+#endif
+    expandScalar(src, channels, dst, done, pixelCount);
+}
+
+void ImageKernels::PremultiplyAlpha(uint8_t* rgba, size_t pixelCount) {
+    size_t done = 0;
+#ifdef IMAGE_KERNELS_X86
+    switch (Active()) {
+    case Isa::AVX2: done = premultiplyAVX2(rgba, pixelCount); break;
+    case Isa::SSE2: done = premultiplySSE2(rgba, pixelCount); break;
+    default: break;
+    }
+#endif
+    premultiplyScalar(rgba, done, pixelCount);
+}
+
+void ImageKernels::Downsample2x(const uint8_t* src, int width, int height, uint8_t* dst) {
+    const int outWidth = NextMipSize(width);
+    const int outHeight = NextMipSize(height);
+    const size_t rowBytes = static_cast<size_t>(width) * 4;
+#ifdef IMAGE_KERNELS_X86
+    const Isa isa = width >= 2 ? Active() : Isa::Scalar; // The vector loops read pixel pairs
+#endif
+
+    for (int y = 0; y < outHeight; y++) {
+        const uint8_t* row0 = src + rowBytes * std::min(2 * y, height - 1);
+        const uint8_t* row1 = src + rowBytes * std::min(2 * y + 1, height - 1);
+        uint8_t* out = dst + static_cast<size_t>(y) * outWidth * 4;
+
+        int done = 0;
+#ifdef IMAGE_KERNELS_X86
+        if (isa == Isa::AVX2) done = downsampleRowAVX2(row0, row1, out, outWidth);
+        if (isa >= Isa::SSE2) done += downsampleRowSSE2(row0 + done * 8, row1 + done * 8, out + done * 4, outWidth - done);
+#endif
+        downsampleRowScalar(row0, row1, width, out, done, outWidth);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * ImageKernels: The per-pixel loops of texture loading, vectorized with SSE2 and AVX2 and
+ * picked at runtime from what the CPU supports. Every variant gives exactly the same bytes
+ * as the scalar one (the benchmark's kernels suite checks this), so output never depends
+ * on the machine that produced it. Stateless apart from the ISA choice, safe on any thread.
+ */
+class ImageKernels {
+public:
+    enum class Isa {
+        Scalar,
+        SSE2,
+        AVX2,
+    };
+
+    static Isa Supported();          // Best this CPU (and build) can run
+    static Isa Active();             // What the kernels below use, Supported() by default
+    static void SetActive(Isa isa);  // Clamped to Supported(); for tests and benchmarks
+    static const char* IsaName(Isa isa);
+
+    // dst gets src's rows in reverse order (GL wants the bottom row first)
+    static void FlipVertical(const uint8_t* src, uint8_t* dst, size_t rowBytes, int rows);
+
+    // 1 (grey), 2 (grey + alpha), 3 (RGB) or 4 channels to RGBA8. Missing alpha is 255.
+    static void ExpandToRGBA(const uint8_t* src, int channels, uint8_t* dst, size_t pixelCount);
+
+    // RGB = round(RGB * A / 255) in place, alpha untouched
+    static void PremultiplyAlpha(uint8_t* rgba, size_t pixelCount);
+
+    /**
+     * Downsample 2x: Next mip level of an RGBA8 image, each pixel the rounded average of a
+     * 2x2 box. The result is max(1, width / 2) by max(1, height / 2); a 1 pixel wide or tall
+     * source averages its single column or row with itself.
+     */
+    static void Downsample2x(const uint8_t* src, int width, int height, uint8_t* dst);
+    static int NextMipSize(int size) { return size > 1 ? size / 2 : 1; }
+};
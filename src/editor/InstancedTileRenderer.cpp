@@ -0,0 +1,130 @@
+#include "InstancedTileRenderer.h"
+#include "AssetManager.h"
+#include <algorithm>
+#include <unordered_set>
+#include <iostream>
+
+InstancedTileRenderer::~InstancedTileRenderer() {
+    if (m_instanceVBO) glDeleteBuffers(1, &m_instanceVBO);
+}
+
+void InstancedTileRenderer::init(GLuint quadVAO, const Shader& shader) {
+    m_vao = quadVAO;
+    m_program = shader.id;
+
+    glGenBuffers(1, &m_instanceVBO);
+
+    // Locations 0/1 (unit quad) are already set up on the VAO, add the per-instance ones
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+    glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, x));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+
+    glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Instance), (void*)offsetof(Instance, region));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+
+    glBindVertexArray(0);
+
+    m_cellSizeLoc = shader.location("uCellSize");
+    m_textureLoc = shader.location("uTexture");
+    m_regionsLoc = shader.location("uRegions");
+}
+
+void InstancedTileRenderer::update(const EntityStore& entities, const std::vector<uint32_t>& tiles, unsigned int revision) {
+    m_stats.bytesUploaded = 0;
+    if (m_hasUploaded && revision == m_uploadedRevision) return;
+
+    struct Keyed {
+        int page;
+        Instance instance;
+    };
+
+    std::vector<Keyed> keyed;
+    keyed.reserve(tiles.size());
+    m_queue.clear();
+    m_queue.reserve(tiles.size());
+
+    // Atlas regions come from the per-asset slots, no lookup by name
+    std::unordered_set<AssetId> missing;
+    for (uint32_t tile : tiles) {
+        Entity e = entities.entity(tile);
+        const AtlasRegion* region = AssetManager::GetTextureSlot(e.type).region;
+        if (!region) {
+            if (missing.insert(e.type).second)
+                std::cerr << "Instanced: no atlas region for " << AssetRegistry::Name(e.type) << ", skipping\n";
+            continue;
+        }
+
+        // Layer order first so blending stays correct, page second to keep runs long
+        m_queue.push(RenderQueue::makeKey(e.layer, 0, static_cast<uint32_t>(region->page)),
+            static_cast<uint32_t>(keyed.size()));
+        keyed.push_back({ region->page,
+            { e.x, e.y, e.layer * 0.01f, static_cast<uint32_t>(region->index) } });
+    }
+    m_queue.sort();
+
+    m_instances.clear();
+    m_runs.clear();
+    int runPage = -1;
+    for (auto& item : m_queue.items()) {
+        const Keyed& k = keyed[item.index];
+        if (m_runs.empty() || k.page != runPage) {
+            m_runs.push_back({ AssetManager::GetAtlasPageHandle(k.page), m_instances.size(), 0 });
+            runPage = k.page;
+        }
+        m_runs.back().count++;
+        m_instances.push_back(k.instance);
+    }
+
+    // Grow geometrically, otherwise just overwrite the existing storage
+    size_t bytes = m_instances.size() * sizeof(Instance);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+    if (m_instances.size() > m_capacity) {
+        m_capacity = std::max(m_instances.size(), m_capacity * 2);
+        glBufferData(GL_ARRAY_BUFFER, m_capacity * sizeof(Instance), nullptr, GL_DYNAMIC_DRAW);
+    }
+    if (bytes > 0)
+        glBufferSubData(GL_ARRAY_BUFFER, 0, bytes, m_instances.data());
+
+    m_stats.bytesUploaded = bytes;
+    m_uploadedRevision = revision;
+    m_hasUploaded = true;
+}
+
+void InstancedTileRenderer::draw(float cellWidth, float cellHeight) {
+    size_t bytesUploaded = m_stats.bytesUploaded;
+    m_stats = RenderStats{};
+    m_stats.bytesUploaded = bytesUploaded;
+    if (m_instances.empty()) return;
+
+    glUseProgram(m_program);
+    glUniform2f(m_cellSizeLoc, cellWidth, cellHeight);
+    glUniform1i(m_textureLoc, 0);
+    glUniform1i(m_regionsLoc, 1);
+
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_BUFFER, AssetManager::GetAtlasRegionBuffer());
+    glActiveTexture(GL_TEXTURE0);
+
+    glBindVertexArray(m_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceVBO);
+
+    for (auto& run : m_runs) {
+        glBindTexture(GL_TEXTURE_2D, run.texture);
+        m_stats.textureBinds++;
+
+        // GL 3.3 has no base-instance draw, so point the instance attributes at the run
+        size_t offset = run.first * sizeof(Instance);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)(offset + offsetof(Instance, x)));
+        glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(Instance), (void*)(offset + offsetof(Instance, region)));
+
+        glDrawElementsInstanced(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0, static_cast<GLsizei>(run.count));
+        m_stats.drawCalls++;
+    }
+
+    m_stats.sprites = static_cast<int>(m_instances.size());
+    m_stats.vertices = m_stats.sprites * 4; // Vertices processed, the buffer itself holds one quad
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "EntityStore.h"
+#include "RenderSettings.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+
+/**
+ * InstancedTileRenderer: Draws every tile as an instance of the editor's unit quad.
+ * Per-instance data (position, layer depth, atlas region index) lives in one buffer
+ * that is only re-uploaded when the scene revision changes, so an idle frame is a
+ * few glDrawElementsInstanced calls and no uploads.
+ */
+class InstancedTileRenderer {
+public:
+    InstancedTileRenderer() = default;
+    ~InstancedTileRenderer();
+
+    InstancedTileRenderer(const InstancedTileRenderer&) = delete;
+    InstancedTileRenderer& operator=(const InstancedTileRenderer&) = delete;
+
+    /**
+     * Init: Attaches the instance attributes (locations 2 and 3) to quadVAO and caches
+     * the uniform locations of the instanced sprite program.
+     */
+    void init(GLuint quadVAO, const Shader& shader);
+
+    /**
+     * Update: Rebuilds and uploads the instance buffer if `revision` differs from the
+     * last upload. The caller bumps it when the tile set (or the culled subset) changes.
+     * `tiles` are entity indices into `entities`. Tiles whose texture isn't in the atlas
+     * are skipped.
+     */
+    void update(const EntityStore& entities, const std::vector<uint32_t>& tiles, unsigned int revision);
+
+    /**
+     * Invalidate: Forces the next update() to rebuild (e.g. after the atlas changed).
+     */
+    void invalidate() { m_hasUploaded = false; }
+
+    void draw(float cellWidth, float cellHeight);
+
+    const RenderStats& getStats() const { return m_stats; }
+
+private:
+    struct Instance {
+        float x, y, depth;
+        uint32_t region;
+    };
+
+    // Instances in [first, first + count) share one atlas page
+    struct Run {
+        GLuint texture;
+        size_t first;
+        size_t count;
+    };
+
+    GLuint m_vao = 0;
+    GLuint m_program = 0;
+    GLuint m_instanceVBO = 0;
+    size_t m_capacity = 0;
+
+    GLint m_cellSizeLoc = -1;
+    GLint m_textureLoc = -1;
+    GLint m_regionsLoc = -1;
+
+    std::vector<Instance> m_instances;
+    std::vector<Run> m_runs;
+    RenderQueue m_queue;
+    unsigned int m_uploadedRevision = 0;
+    bool m_hasUploaded = false;
+
+    RenderStats m_stats;
+};
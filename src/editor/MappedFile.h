@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+/**
+ * MappedFile: A whole file mapped read-only into memory (MapViewOfFile on Windows, mmap
+ * elsewhere). Pages are read in by the OS on first touch, so opening is cheap no matter
+ * the size and a warm start reads straight from the page cache.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False if the file is missing, empty or can't be mapped
+    bool open(const std::string& path);
+    void close();
+
+    bool isOpen() const { return m_data != nullptr; }
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+#ifdef _WIN32
+    void* m_file = nullptr;    // HANDLEs, kept as void* so <windows.h> stays out of the header
+    void* m_mapping = nullptr;
+#else
+    int m_fd = -1;
+#endif
+    const unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+};
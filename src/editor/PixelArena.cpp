@@ -0,0 +1,238 @@
+#include "PixelArena.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+    std::atomic<bool> s_enabled{ true };
+    std::atomic<uint64_t> s_systemAllocations{ 0 };
+
+    // Kept by each decode thread for the next image; small PNGs decode entirely inside it
+    constexpr size_t kScratchChunkBytes = 1024 * 1024;
+
+    // Scratch arena of the ScratchScope open on this thread, if any
+    thread_local PixelArena* t_scratch = nullptr;
+
+    PixelArena& threadScratch() {
+        thread_local PixelArena arena(kScratchChunkBytes, kScratchChunkBytes);
+        return arena;
+    }
+
+    size_t alignUp(size_t bytes) {
+        return (bytes + PixelArena::kAlignment - 1) & ~(PixelArena::kAlignment - 1);
+    }
+
+    unsigned char* systemAllocate(size_t bytes) {
+        s_systemAllocations.fetch_add(1, std::memory_order_relaxed);
+        return static_cast<unsigned char*>(::operator new(bytes, std::align_val_t(PixelArena::kAlignment), std::nothrow));
+    }
+
+    void systemFree(unsigned char* data) {
+        ::operator delete(data, std::align_val_t(PixelArena::kAlignment));
+    }
+
+    // In front of every stb_image block, so free and realloc know where it came from
+    struct alignas(PixelArena::kAlignment) StbHeader {
+        size_t bytes;
+        PixelArena* arena; // nullptr: a system block
+    };
+}
+
+PixelArena::PixelArena(size_t chunkBytes, size_t retainBytes)
+    : m_chunkBytes(alignUp(std::max<size_t>(chunkBytes, kAlignment))), m_retainBytes(retainBytes) {
+}
+
+PixelArena::~PixelArena() {
+    for (Chunk& chunk : m_chunks) systemFree(chunk.data);
+}
+
+unsigned char* PixelArena::allocate(size_t bytes) {
+    size_t aligned = alignUp(std::max<size_t>(bytes, 1));
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (!m_chunks.empty()) {
+        Chunk& current = m_chunks.back();
+        if (current.size - current.used >= aligned) {
+            unsigned char* block = current.data + current.used;
+            current.used += aligned;
+            m_usedBytes += aligned;
+            m_live.fetch_add(1, std::memory_order_relaxed);
+            return block;
+        }
+    }
+
+    // Big requests get a chunk of their own and leave the current one open, so its free
+    // tail is still there for the next small one
+    bool dedicated = aligned > m_chunkBytes / 4;
+    size_t size = dedicated ? aligned : m_chunkBytes;
+    unsigned char* data = systemAllocate(size);
+    if (!data) return nullptr;
+
+    Chunk chunk{ data, size, aligned };
+    if (dedicated && !m_chunks.empty())
+        m_chunks.insert(m_chunks.end() - 1, chunk);
+    else
+        m_chunks.push_back(chunk);
+
+    m_reservedBytes += size;
+    m_peakReservedBytes = std::max(m_peakReservedBytes, m_reservedBytes);
+    m_usedBytes += aligned;
+    m_live.fetch_add(1, std::memory_order_relaxed);
+    return data;
+}
+
+void PixelArena::release() {
+    m_live.fetch_sub(1, std::memory_order_release);
+}
+
+bool PixelArena::tryGrow(const unsigned char* block, size_t oldBytes, size_t newBytes) {
+    size_t oldAligned = alignUp(std::max<size_t>(oldBytes, 1));
+    size_t newAligned = alignUp(std::max<size_t>(newBytes, 1));
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (auto it = m_chunks.rbegin(); it != m_chunks.rend(); ++it) {
+        Chunk& chunk = *it;
+        if (block < chunk.data || block >= chunk.data + chunk.size) continue;
+
+        size_t offset = static_cast<size_t>(block - chunk.data);
+        if (offset + oldAligned != chunk.used || chunk.size - offset < newAligned)
+            return false; // Not the last block of its chunk, or no room after it
+        m_usedBytes = m_usedBytes - oldAligned + newAligned;
+        chunk.used = offset + newAligned;
+        return true;
+    }
+    return false;
+}
+
+bool PixelArena::reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_live.load(std::memory_order_acquire) != 0) return false;
+
+    Chunk kept{ nullptr, 0, 0 };
+    for (Chunk& chunk : m_chunks) {
+        if (!kept.data && chunk.size <= m_retainBytes)
+            kept = chunk;
+        else
+            systemFree(chunk.data);
+    }
+    m_chunks.clear();
+    m_reservedBytes = 0;
+    if (kept.data) {
+        kept.used = 0;
+        m_chunks.push_back(kept);
+        m_reservedBytes = kept.size;
+    }
+    m_usedBytes = 0;
+    return true;
+}
+
+PixelArena::Stats PixelArena::stats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return { m_chunks.size(), m_reservedBytes, m_usedBytes, m_peakReservedBytes, m_live.load(std::memory_order_relaxed) };
+}
+
+void PixelArena::SetEnabled(bool enabled) {
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool PixelArena::Enabled() {
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+uint64_t PixelArena::SystemAllocations() {
+    return s_systemAllocations.load(std::memory_order_relaxed);
+}
+
+PixelArena::ScratchScope::ScratchScope() {
+    if (!Enabled()) return;
+    m_outermost = t_scratch == nullptr;
+    if (m_outermost) t_scratch = &threadScratch();
+    m_arena = t_scratch;
+}
+
+PixelArena::ScratchScope::~ScratchScope() {
+    if (!m_outermost) return;
+    t_scratch = nullptr;
+    m_arena->reset(); // Everything allocated in the scope must be freed by now
+}
+
+void* PixelArena::StbMalloc(size_t bytes) {
+    // Big blocks (the zlib stream and decoded image of a large PNG) go to the system: freed
+    // right away, they don't pile up in the arena until the scope ends
+    size_t total = sizeof(StbHeader) + bytes;
+    PixelArena* arena = total <= kScratchChunkBytes / 4 ? t_scratch : nullptr;
+    unsigned char* raw = arena ? arena->allocate(total) : systemAllocate(total);
+    if (!raw) return nullptr;
+
+    StbHeader* header = reinterpret_cast<StbHeader*>(raw);
+    header->bytes = bytes;
+    header->arena = arena;
+    return raw + sizeof(StbHeader);
+}
+
+void* PixelArena::StbRealloc(void* block, size_t bytes) {
+    if (!block) return StbMalloc(bytes);
+
+    unsigned char* raw = static_cast<unsigned char*>(block) - sizeof(StbHeader);
+    StbHeader* header = reinterpret_cast<StbHeader*>(raw);
+    // zlib output and PNG chunk data grow one block at a time, usually at the arena's end
+    if (header->arena && header->arena->tryGrow(raw, sizeof(StbHeader) + header->bytes, sizeof(StbHeader) + bytes)) {
+        header->bytes = bytes;
+        return block;
+    }
+
+    void* grown = StbMalloc(bytes);
+    if (!grown) return nullptr; // Like realloc, the old block stays valid
+    std::memcpy(grown, block, std::min(header->bytes, bytes));
+    StbFree(block);
+    return grown;
+}
+
+void PixelArena::StbFree(void* block) {
+    if (!block) return;
+
+    unsigned char* raw = static_cast<unsigned char*>(block) - sizeof(StbHeader);
+    StbHeader* header = reinterpret_cast<StbHeader*>(raw);
+    if (header->arena)
+        header->arena->release();
+    else
+        systemFree(raw);
+}
+
+PixelBuffer::PixelBuffer(size_t bytes, PixelArena* arena) {
+    if (bytes == 0) return;
+    m_data = arena ? arena->allocate(bytes) : systemAllocate(bytes);
+    if (!m_data) throw std::bad_alloc();
+    m_size = bytes;
+    m_arena = arena;
+}
+
+PixelBuffer::PixelBuffer(PixelBuffer&& other) noexcept
+    : m_data(other.m_data), m_size(other.m_size), m_arena(other.m_arena) {
+    other.m_data = nullptr;
+    other.m_size = 0;
+    other.m_arena = nullptr;
+}
+
+PixelBuffer& PixelBuffer::operator=(PixelBuffer&& other) noexcept {
+    if (this != &other) {
+        clear();
+        std::swap(m_data, other.m_data);
+        std::swap(m_size, other.m_size);
+        std::swap(m_arena, other.m_arena);
+    }
+    return *this;
+}
+
+void PixelBuffer::clear() {
+    if (m_data) {
+        if (m_arena)
+            m_arena->release();
+        else
+            systemFree(m_data);
+    }
+    m_data = nullptr;
+    m_size = 0;
+    m_arena = nullptr;
+}
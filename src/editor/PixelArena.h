@@ -0,0 +1,124 @@
+#pragma once
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * PixelArena: Bump allocator for decoded images. Memory comes from the system in large
+ * chunks and allocations are carved off the end, so a load batch costs a handful of system
+ * allocations instead of several per texture. Single allocations are never given back;
+ * reset() releases everything at once when nothing in the arena is used any more.
+ * Thread-safe, decode threads share one.
+ *
+ * stb_image allocates through StbMalloc / StbRealloc / StbFree (see stb_impl.cpp). Inside a
+ * ScratchScope those come from a per-thread arena that is rewound when the scope ends, so
+ * a decode thread reuses the same memory for every image it decodes.
+ */
+class PixelArena {
+public:
+    static constexpr size_t kChunkBytes = 16 * 1024 * 1024;
+    static constexpr size_t kAlignment = 16;
+
+    /**
+     * Constructor: retainBytes of memory survive reset() (one chunk, if it is no bigger),
+     * for an arena that is refilled right away.
+     */
+    explicit PixelArena(size_t chunkBytes = kChunkBytes, size_t retainBytes = 0);
+    ~PixelArena();
+
+    PixelArena(const PixelArena&) = delete;
+    PixelArena& operator=(const PixelArena&) = delete;
+
+    // kAlignment-aligned, uninitialized. Pair every allocate() with one release().
+    unsigned char* allocate(size_t bytes);
+    void release();
+
+    // Extends the most recent allocation in place if the chunk has room; false otherwise
+    bool tryGrow(const unsigned char* block, size_t oldBytes, size_t newBytes);
+
+    // Frees the chunks; false (and frees nothing) while allocations are still live
+    bool reset();
+
+    struct Stats {
+        size_t chunks;
+        size_t reservedBytes;     // Taken from the system
+        size_t usedBytes;         // Handed out since the last reset
+        size_t peakReservedBytes;
+        size_t liveAllocations;
+    };
+    Stats stats() const;
+
+    // Off: ScratchScope does nothing and callers should allocate per image (for comparisons)
+    static void SetEnabled(bool enabled);
+    static bool Enabled();
+
+    // Allocations made from the system by arenas, PixelBuffers and stb_image, process-wide
+    static uint64_t SystemAllocations();
+
+    class ScratchScope {
+    public:
+        ScratchScope();
+        ~ScratchScope();
+
+        ScratchScope(const ScratchScope&) = delete;
+        ScratchScope& operator=(const ScratchScope&) = delete;
+
+        // This thread's scratch arena; nullptr if the arena is disabled
+        PixelArena* arena() const { return m_arena; }
+
+    private:
+        PixelArena* m_arena = nullptr;
+        bool m_outermost = false; // Only the outermost scope on a thread rewinds
+    };
+
+    static void* StbMalloc(size_t bytes);
+    static void* StbRealloc(void* block, size_t bytes);
+    static void StbFree(void* block);
+
+private:
+    struct Chunk {
+        unsigned char* data;
+        size_t size;
+        size_t used;
+    };
+
+    size_t m_chunkBytes;
+    size_t m_retainBytes;
+    std::vector<Chunk> m_chunks; // The last one is the one being filled
+    size_t m_reservedBytes = 0;
+    size_t m_usedBytes = 0;
+    size_t m_peakReservedBytes = 0;
+    std::atomic<size_t> m_live{ 0 };
+    mutable std::mutex m_mutex;
+};
+
+/**
+ * PixelBuffer: One decoded image level. Its own heap block, or a slice of a PixelArena that
+ * outlives it; either way uninitialized until written. Move-only.
+ */
+class PixelBuffer {
+public:
+    PixelBuffer() = default;
+    explicit PixelBuffer(size_t bytes, PixelArena* arena = nullptr);
+    ~PixelBuffer() { clear(); }
+
+    PixelBuffer(PixelBuffer&& other) noexcept;
+    PixelBuffer& operator=(PixelBuffer&& other) noexcept;
+    PixelBuffer(const PixelBuffer&) = delete;
+    PixelBuffer& operator=(const PixelBuffer&) = delete;
+
+    unsigned char* data() { return m_data; }
+    const unsigned char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    PixelArena* arena() const { return m_arena; }
+
+    void clear();
+
+private:
+    unsigned char* m_data = nullptr;
+    size_t m_size = 0;
+    PixelArena* m_arena = nullptr;
+};
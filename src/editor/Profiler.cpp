@@ -0,0 +1,238 @@
+#include "Profiler.h"
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <cstring>
+
+using json = nlohmann::json;
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kGpuTrack = 1000; // Trace "thread" the GPU zones are drawn on
+
+    struct OpenZone {
+        const char* name;
+        double startUs;
+    };
+
+    struct PendingQuery {
+        GLuint id;
+        const char* name;
+        uint64_t frame;
+    };
+
+    const Clock::time_point s_origin = Clock::now();
+    const std::thread::id s_mainThread = std::this_thread::get_id();
+    std::atomic<uint32_t> s_nextThread{ 1 };
+
+    std::mutex s_mutex; // Guards the current frame's vectors, workers add zones to it
+    std::vector<Profiler::Frame> s_frames(Profiler::kHistory);
+    uint64_t s_frameIndex = 0; // Frame 0 collects start-up zones until the first BeginFrame
+    bool s_frameOpen = true;
+    bool s_enabled = true;
+
+    std::vector<GLuint> s_freeQueries;
+    std::deque<PendingQuery> s_pendingQueries;
+    int s_gpuDepth = 0; // GL_TIME_ELAPSED can't nest, only the outermost GPU zone gets a query
+    bool s_gpuQueryActive = false;
+
+    thread_local std::vector<OpenZone> t_openZones;
+    thread_local uint32_t t_threadId = ~0u;
+
+    double nowUs() {
+        return std::chrono::duration<double, std::micro>(Clock::now() - s_origin).count();
+    }
+
+    uint32_t threadId() {
+        if (t_threadId == ~0u)
+            t_threadId = (std::this_thread::get_id() == s_mainThread) ? 0 : s_nextThread++;
+        return t_threadId;
+    }
+
+    Profiler::Frame& currentFrame() {
+        return s_frames[s_frameIndex % Profiler::kHistory];
+    }
+
+    void resolveGpuQueries() {
+        while (!s_pendingQueries.empty()) {
+            const PendingQuery& query = s_pendingQueries.front();
+            GLint available = 0;
+            glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) break; // Results come back in order, the rest aren't ready either
+
+            GLuint64 ns = 0;
+            glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &ns);
+
+            // The frame may already have left the ring buffer if the GPU is far behind
+            Profiler::Frame& frame = s_frames[query.frame % Profiler::kHistory];
+            if (frame.index == query.frame)
+                frame.gpuZones.push_back({ query.name, ns / 1000.0 });
+
+            s_freeQueries.push_back(query.id);
+            s_pendingQueries.pop_front();
+        }
+    }
+}
+
+void Profiler::BeginFrame() {
+    if (s_frameOpen) EndFrame(); // Closes the start-up frame (or a frame that never ended)
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_frameIndex++;
+    Frame& frame = currentFrame();
+    frame.index = s_frameIndex;
+    frame.startUs = nowUs();
+    frame.durationUs = 0.0;
+    frame.zones.clear();
+    frame.gpuZones.clear();
+    frame.counters.clear();
+    s_frameOpen = true;
+}
+
+void Profiler::EndFrame() {
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        Frame& frame = currentFrame();
+        frame.durationUs = nowUs() - frame.startUs;
+        s_frameOpen = false;
+    }
+    resolveGpuQueries();
+}
+
+void Profiler::SetEnabled(bool enabled) {
+    s_enabled = enabled;
+}
+
+bool Profiler::IsEnabled() {
+    return s_enabled;
+}
+
+void Profiler::BeginZone(const char* name) {
+    // Pushed even when disabled so EndZone always pops its own zone
+    t_openZones.push_back({ s_enabled ? name : nullptr, nowUs() });
+}
+
+void Profiler::EndZone() {
+    if (t_openZones.empty()) return;
+
+    OpenZone open = t_openZones.back();
+    t_openZones.pop_back();
+    if (!open.name) return;
+
+    Zone zone{ open.name, threadId(), static_cast<uint32_t>(t_openZones.size()), open.startUs, nowUs() - open.startUs };
+    std::lock_guard<std::mutex> lock(s_mutex);
+    currentFrame().zones.push_back(zone);
+}
+
+void Profiler::BeginGpuZone(const char* name) {
+    if (s_gpuDepth++ > 0 || !s_enabled) return;
+
+    GLuint id = 0;
+    if (!s_freeQueries.empty()) {
+        id = s_freeQueries.back();
+        s_freeQueries.pop_back();
+    }
+    else {
+        glGenQueries(1, &id);
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, id);
+    s_pendingQueries.push_back({ id, name, s_frameIndex });
+    s_gpuQueryActive = true;
+}
+
+void Profiler::EndGpuZone() {
+    if (s_gpuDepth == 0) return;
+    if (--s_gpuDepth > 0) return;
+
+    // Only end a query we actually began (the zone may have opened while disabled)
+    if (s_gpuQueryActive) {
+        glEndQuery(GL_TIME_ELAPSED);
+        s_gpuQueryActive = false;
+    }
+}
+
+void Profiler::SetCounter(const char* name, double value) {
+    if (!s_enabled) return;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto& counter : currentFrame().counters) {
+        if (std::strcmp(counter.name, name) == 0) {
+            counter.value = value;
+            return;
+        }
+    }
+    currentFrame().counters.push_back({ name, value });
+}
+
+std::vector<const Profiler::Frame*> Profiler::History() {
+    std::vector<const Frame*> frames;
+    frames.reserve(kHistory);
+
+    // Oldest first; the open frame is still being written
+    uint64_t newest = s_frameOpen ? s_frameIndex : s_frameIndex + 1;
+    uint64_t oldest = newest > static_cast<uint64_t>(kHistory - 1) ? newest - (kHistory - 1) : 0;
+    for (uint64_t i = oldest; i < newest; i++) {
+        const Frame& frame = s_frames[i % kHistory];
+        if (frame.index == i) frames.push_back(&frame);
+    }
+    return frames;
+}
+
+bool Profiler::ExportChromeTrace(const std::string& path) {
+    json events = json::array();
+    events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0}, {"args", {{"name", "Main"}}} });
+    events.push_back({ {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", kGpuTrack}, {"args", {{"name", "GPU"}}} });
+
+    for (const Frame* frame : History()) {
+        events.push_back({ {"name", "Frame " + std::to_string(frame->index)}, {"cat", "frame"}, {"ph", "X"},
+            {"ts", frame->startUs}, {"dur", frame->durationUs}, {"pid", 1}, {"tid", 0} });
+
+        for (auto& zone : frame->zones) {
+            events.push_back({ {"name", zone.name}, {"cat", "cpu"}, {"ph", "X"},
+                {"ts", zone.startUs}, {"dur", zone.durationUs}, {"pid", 1}, {"tid", zone.thread} });
+        }
+
+        // Elapsed-time queries have no timestamps, so lay the GPU zones end to end from the frame start
+        double gpuCursor = frame->startUs;
+        for (auto& zone : frame->gpuZones) {
+            events.push_back({ {"name", zone.name}, {"cat", "gpu"}, {"ph", "X"},
+                {"ts", gpuCursor}, {"dur", zone.durationUs}, {"pid", 1}, {"tid", kGpuTrack} });
+            gpuCursor += zone.durationUs;
+        }
+
+        for (auto& counter : frame->counters) {
+            events.push_back({ {"name", counter.name}, {"ph", "C"}, {"ts", frame->startUs},
+                {"pid", 1}, {"args", {{"value", counter.value}}} });
+        }
+    }
+
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Profiler: could not write " << path << "\n";
+        return false;
+    }
+
+    json trace;
+    trace["traceEvents"] = std::move(events);
+    trace["displayTimeUnit"] = "ms";
+    file << trace.dump();
+    std::cout << "Profiler: wrote " << path << "\n";
+    return true;
+}
+
+void Profiler::Shutdown() {
+    for (auto& query : s_pendingQueries) {
+        s_freeQueries.push_back(query.id);
+    }
+    s_pendingQueries.clear();
+    if (!s_freeQueries.empty())
+        glDeleteQueries(static_cast<GLsizei>(s_freeQueries.size()), s_freeQueries.data());
+    s_freeQueries.clear();
+}
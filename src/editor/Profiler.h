@@ -0,0 +1,98 @@
+#pragma once
+#include <glad/glad.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * Profiler: Frame-based timing for the editor. CPU zones are scoped wall-clock timers
+ * (any thread), GPU zones wrap GL_TIME_ELAPSED queries that are read back a few frames
+ * later so the CPU never waits on the GPU. Counters are per-frame values (draw calls,
+ * bytes uploaded...). The last kHistory frames live in a ring buffer, which the Profiler
+ * panel graphs and ExportChromeTrace() writes out for chrome://tracing or Perfetto.
+ *
+ * All static like AssetManager, so a zone can be opened from anywhere with PROFILE_SCOPE.
+ */
+class Profiler {
+public:
+    static constexpr int kHistory = 300;
+
+    struct Zone {
+        const char* name;    // Must be a string literal / outlive the profiler
+        uint32_t thread;     // Small id, 0 = main thread
+        uint32_t depth;      // Nesting on that thread
+        double startUs;      // Relative to profiler start
+        double durationUs;
+    };
+
+    struct GpuZone {
+        const char* name;
+        double durationUs;
+    };
+
+    struct Counter {
+        const char* name;
+        double value;
+    };
+
+    struct Frame {
+        uint64_t index = 0;
+        double startUs = 0.0;
+        double durationUs = 0.0;
+        std::vector<Zone> zones;
+        std::vector<GpuZone> gpuZones;
+        std::vector<Counter> counters;
+    };
+
+    /**
+     * Begin / end frame: Bracket one editor frame. EndFrame() also collects GPU query
+     * results that have become available for earlier frames.
+     */
+    static void BeginFrame();
+    static void EndFrame();
+
+    static void SetEnabled(bool enabled);
+    static bool IsEnabled();
+
+    // Prefer PROFILE_SCOPE / PROFILE_GPU_SCOPE over calling these directly
+    static void BeginZone(const char* name);
+    static void EndZone();
+    static void BeginGpuZone(const char* name);
+    static void EndGpuZone();
+
+    /**
+     * Counter: Records a value for the current frame; setting the same name twice keeps the last.
+     */
+    static void SetCounter(const char* name, double value);
+
+    /**
+     * History: Frames oldest to newest. Only call from the main thread between frames
+     * (i.e. from UI code), the current frame is not included.
+     */
+    static std::vector<const Frame*> History();
+
+    /**
+     * Export Chrome trace: Writes every frame in the ring buffer as trace events (CPU zones
+     * per thread, GPU zones on their own track, counters as counter events). Returns false
+     * if the file couldn't be written.
+     */
+    static bool ExportChromeTrace(const std::string& path);
+
+    static void Shutdown();
+};
+
+// RAII helpers
+struct ProfileScope {
+    explicit ProfileScope(const char* name) { Profiler::BeginZone(name); }
+    ~ProfileScope() { Profiler::EndZone(); }
+};
+
+struct GpuProfileScope {
+    explicit GpuProfileScope(const char* name) { Profiler::BeginGpuZone(name); }
+    ~GpuProfileScope() { Profiler::EndGpuZone(); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope_, __LINE__)(name)
@@ -0,0 +1,50 @@
+#pragma once
+#include <vector>
+#include <string>
+#include "RenderSettings.h"
+
+// What Editor::runRenderBenchmark renders: every tile count x every mode
+struct RenderBenchmarkConfig {
+    std::vector<int> tileCounts = { 1000, 10000, 100000, 1000000 };
+    std::vector<RenderMode> modes = { RenderMode::Batched, RenderMode::Instanced, RenderMode::Chunked, RenderMode::Array };
+    int layers = 4;          // Tiles are spread evenly over layers 0..layers-1
+    int frames = 300;        // Measured frames per run, spread over the camera script
+    int warmupFrames = 30;   // Not measured; chunk builds are also waited for here
+    unsigned int seed = 1234;
+};
+
+// One (tile count, mode) run. Frame times cover grid + entities up to glFinish().
+struct RenderBenchmarkResult {
+    int tiles = 0;
+    int layers = 0;
+    RenderMode mode = RenderMode::Batched;
+    int frames = 0;
+    double meanMs = 0.0;
+    double p50Ms = 0.0;
+    double p90Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double maxMs = 0.0;
+    double avgDrawCalls = 0.0;
+    double avgVisible = 0.0;
+};
+
+// Editor construction to fully loaded, frames drawn (grid + entities, no ImGui) while textures stream
+struct StartupBenchmarkResult {
+    bool progressive = true;
+    int textures = 0;
+    double firstFrameMs = 0.0;
+    double fullyLoadedMs = 0.0;
+    int frames = 0;            // Frames until fully loaded, the first one included
+    double maxFrameMs = 0.0;   // Longest of them, upload and finalize work included
+};
+
+inline const char* RenderModeName(RenderMode mode) {
+    switch (mode) {
+    case RenderMode::Batched: return "batched";
+    case RenderMode::Instanced: return "instanced";
+    case RenderMode::Chunked: return "chunked";
+    case RenderMode::Array: return "array";
+    }
+    return "unknown";
+}
@@ -0,0 +1,50 @@
+#include "RenderQueue.h"
+
+static constexpr int kDigits = 8;       // 8 bits per pass, 8 passes for a 64-bit key
+static constexpr int kSmallQueue = 64;  // Below this, the histogram setup costs more than it saves
+
+void RenderQueue::sort() {
+    size_t n = m_items.size();
+    if (n < 2) return;
+
+    if (n < kSmallQueue) {
+        // Insertion sort is stable too, and cheaper for a handful of items
+        for (size_t i = 1; i < n; i++) {
+            Item item = m_items[i];
+            size_t j = i;
+            while (j > 0 && m_items[j - 1].key > item.key) {
+                m_items[j] = m_items[j - 1];
+                j--;
+            }
+            m_items[j] = item;
+        }
+        return;
+    }
+
+    // Histograms for every digit in one pass over the keys
+    uint32_t counts[kDigits][256] = {};
+    for (auto& item : m_items) {
+        for (int d = 0; d < kDigits; d++) {
+            counts[d][(item.key >> (d * 8)) & 0xff]++;
+        }
+    }
+
+    m_scratch.resize(n);
+    for (int d = 0; d < kDigits; d++) {
+        // Every key has the same byte here (unused shader bits, one layer...), nothing to do
+        uint32_t* count = counts[d];
+        if (count[(m_items[0].key >> (d * 8)) & 0xff] == n) continue;
+
+        uint32_t offsets[256];
+        uint32_t sum = 0;
+        for (int b = 0; b < 256; b++) {
+            offsets[b] = sum;
+            sum += count[b];
+        }
+
+        for (auto& item : m_items) {
+            m_scratch[offsets[(item.key >> (d * 8)) & 0xff]++] = item;
+        }
+        m_items.swap(m_scratch);
+    }
+}
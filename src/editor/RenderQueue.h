@@ -0,0 +1,51 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * RenderQueue: Draw order lives here, not in the scene. Renderers push one 64-bit sort key
+ * per item plus an index back into their own data, then sort() orders just those items
+ * with an LSD radix sort. Radix sort is stable, so equal keys keep submission order, and
+ * byte passes where every key has the same digit are skipped.
+ *
+ * Key layout, most significant first:
+ *   [63..48] layer (signed, biased)   draw order, blending depends on it
+ *   [47..32] shader / program slot    0 when a renderer only uses one
+ *   [31..0]  texture                  groups binds inside a layer
+ */
+class RenderQueue {
+public:
+    struct Item {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    static uint64_t makeKey(int layer, uint32_t shader, uint32_t texture) {
+        // Clamp to the 16-bit field; bias so negative layers sort before positive ones
+        int clamped = layer < -32768 ? -32768 : (layer > 32767 ? 32767 : layer);
+        uint64_t biasedLayer = static_cast<uint64_t>(clamped + 32768);
+        return (biasedLayer << 48) | (static_cast<uint64_t>(shader & 0xffff) << 32) | texture;
+    }
+
+    static int keyLayer(uint64_t key) { return static_cast<int>(key >> 48) - 32768; }
+    static uint32_t keyShader(uint64_t key) { return static_cast<uint32_t>(key >> 32) & 0xffff; }
+    static uint32_t keyTexture(uint64_t key) { return static_cast<uint32_t>(key); }
+
+    void clear() { m_items.clear(); }
+    void reserve(size_t count) { m_items.reserve(count); }
+    void push(uint64_t key, uint32_t index) { m_items.push_back({ key, index }); }
+
+    /**
+     * Sort: Orders the pushed items by key, O(n) per non-trivial byte.
+     */
+    void sort();
+
+    const std::vector<Item>& items() const { return m_items; }
+    size_t size() const { return m_items.size(); }
+    bool empty() const { return m_items.empty(); }
+
+private:
+    std::vector<Item> m_items;
+    std::vector<Item> m_scratch;
+};
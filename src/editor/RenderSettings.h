@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+
+// How Editor::drawEntities submits tiles. Selectable at runtime from the Render panel.
+enum class RenderMode {
+    Batched = 0,   // SpriteBatch: world-space quads streamed every frame
+    Instanced = 1, // InstancedTileRenderer: one instance per tile, uploaded only on change
+    Chunked = 2,   // TileChunkCache: static per-chunk meshes, rebuilt only where tiles changed
+    Array = 3,     // SpriteBatch + sprite_array shader: same-size tiles sample one texture array
+};
+
+// Per-frame counters filled by whichever entity path ran
+struct RenderStats {
+    int drawCalls = 0;
+    int textureBinds = 0;
+    int sprites = 0;
+    int vertices = 0;
+    size_t bytesUploaded = 0;
+    int chunks = 0;
+    int chunksRebuilt = 0;
+    int chunksPending = 0; // Chunk meshes still being generated on worker threads
+    int visible = 0; // Tiles in chunks overlapping the camera rect
+    int culled = 0;  // Tiles skipped without being looked at
+};
+
+// How the Editor gets the asset folder onto the GPU at startup
+struct TextureStreamSettings {
+    bool progressive = true;                 // Off: the constructor blocks until every texture is uploaded
+    size_t maxUploadBytes = 4 * 1024 * 1024; // Per frame while streaming, 0 = no limit
+    float maxUploadMs = 2.0f;                // Per frame while streaming, 0 = no limit
+    // 0: the whole asset folder is loaded at startup (atlas and texture array are built from it).
+    // Otherwise textures load when a visible tile or a palette thumbnail first needs them and
+    // the least recently used are evicted above this many bytes; no atlas or array then.
+    size_t residencyBudgetBytes = 0;
+    // Load from the baked pack next to the asset folder (re-baked for changed files at
+    // startup) instead of decoding every PNG
+    bool assetPack = true;
+};
+
+struct TextureLoadStats {
+    int resident = 0;
+    int total = 0;
+    double firstFrameMs = 0.0;  // Editor construction to the first presented frame
+    double fullyLoadedMs = 0.0; // ... to every texture resident and the atlas/array built, 0 while loading
+};
@@ -1,9 +1,15 @@
 #include "SceneSerializer.h"
 
+namespace {
+    // Binary format: 1 had the hot fields only, 2 adds a component mask and values per entity,
+    // 3 adds the grid's bounded flag
+    constexpr int kBinaryVersion = 3;
+}
 
 // --------------------------------------------------
 // Save JSON: Saves a scene to disk in human-readable JSON format.
-// Writes scene name, grid settings, and all entities (type, position, layer) to a JSON file.
+// Writes scene name, grid settings, and all entities (type, position, layer, plus any
+// collision / animation / tint components) to a JSON file.
 // Useful for debugging and manual editing. Returns false on file write errors.
 // --------------------------------------------------
 bool SceneSerializer::saveJSON(const Scene& scene, const std::string& path)
@@ -16,18 +22,34 @@ bool SceneSerializer::saveJSON(const Scene& scene, const std::string& path)
         {"cellWidth", scene.grid.cellWidth},
         {"cellHeight", scene.grid.cellHeight},
         {"rows", scene.grid.rows},
-        {"cols", scene.grid.cols}
+        {"cols", scene.grid.cols},
+        {"bounded", scene.grid.bounded}
     };
 
     j["entities"] = json::array();
-    for (auto& e : scene.entities)
+    for (auto& archetype : scene.entities.archetypes())
     {
-        j["entities"].push_back({
-            {"type", e.type},
-            {"x", e.x},
-            {"y", e.y},
-            {"layer", e.layer}
-            });
+        for (size_t row = 0; row < archetype.size(); row++)
+        {
+            json e = {
+                {"type", AssetRegistry::Name(archetype.type[row])},
+                {"x", archetype.x[row]},
+                {"y", archetype.y[row]},
+                {"layer", archetype.layer[row]}
+            };
+            if (archetype.mask & ComponentCollision) {
+                auto& c = archetype.collision[row];
+                e["collision"] = { {"width", c.width}, {"height", c.height}, {"solid", c.solid} };
+            }
+            if (archetype.mask & ComponentAnimation) {
+                auto& a = archetype.animation[row];
+                e["animation"] = { {"frameCount", a.frameCount}, {"framesPerSecond", a.framesPerSecond}, {"startTime", a.startTime} };
+            }
+            if (archetype.mask & ComponentTint) {
+                e["tint"] = archetype.tint[row].rgba;
+            }
+            j["entities"].push_back(e);
+        }
     }
 
     std::ofstream file(path);
@@ -66,16 +88,39 @@ bool SceneSerializer::loadJSON(Scene& scene, const std::string& path)
     scene.grid.cellHeight = j["grid"].value("cellHeight", 16.0f);
     scene.grid.rows = j["grid"].value("rows", 30);
     scene.grid.cols = j["grid"].value("cols", 30);
+    scene.grid.bounded = j["grid"].value("bounded", false);
 
     scene.entities.clear();
+    scene.entities.reserve(j["entities"].size());
     for (auto& e : j["entities"])
     {
         Entity ent;
-        ent.type = e["type"];
+        ent.type = AssetRegistry::Intern(e["type"].get<std::string>());
         ent.x = e["x"];
         ent.y = e["y"];
         ent.layer = e["layer"];
-        scene.entities.push_back(ent);
+
+        // Components are optional, older files have none
+        EntityComponents components;
+        if (e.contains("collision")) {
+            auto& c = e["collision"];
+            components.mask |= ComponentCollision;
+            components.collision.width = c.value("width", 0.0f);
+            components.collision.height = c.value("height", 0.0f);
+            components.collision.solid = c.value("solid", true);
+        }
+        if (e.contains("animation")) {
+            auto& a = e["animation"];
+            components.mask |= ComponentAnimation;
+            components.animation.frameCount = a.value("frameCount", 1);
+            components.animation.framesPerSecond = a.value("framesPerSecond", 8.0f);
+            components.animation.startTime = a.value("startTime", 0.0f);
+        }
+        if (e.contains("tint")) {
+            components.mask |= ComponentTint;
+            components.tint.rgba = e["tint"].get<uint32_t>();
+        }
+        scene.entities.create(ent, components);
     }
 
     return true;
@@ -168,8 +213,7 @@ bool SceneSerializer::saveBinary(const Scene& scene, const std::string& path)
     }
 
     // Version number - allows future changes
-    int version = 1;
-    writeInt(out, version);
+    writeInt(out, kBinaryVersion);
 
     writeString(out, scene.name);
 
@@ -177,13 +221,34 @@ bool SceneSerializer::saveBinary(const Scene& scene, const std::string& path)
     writeFloat(out, scene.grid.cellHeight);
     writeInt(out, scene.grid.rows);
     writeInt(out, scene.grid.cols);
+    writeInt(out, scene.grid.bounded ? 1 : 0);
 
     writeInt(out, (int)scene.entities.size());
-    for (auto& e : scene.entities) {
-        writeString(out, e.type);
-        writeFloat(out, e.x);
-        writeFloat(out, e.y);
-        writeInt(out, e.layer);
+    for (auto& archetype : scene.entities.archetypes()) {
+        for (size_t row = 0; row < archetype.size(); row++) {
+            writeString(out, AssetRegistry::Name(archetype.type[row]));
+            writeFloat(out, archetype.x[row]);
+            writeFloat(out, archetype.y[row]);
+            writeInt(out, archetype.layer[row]);
+
+            // Mask, then the values of the flagged components in flag order
+            writeInt(out, (int)archetype.mask);
+            if (archetype.mask & ComponentCollision) {
+                auto& c = archetype.collision[row];
+                writeFloat(out, c.width);
+                writeFloat(out, c.height);
+                writeInt(out, c.solid ? 1 : 0);
+            }
+            if (archetype.mask & ComponentAnimation) {
+                auto& a = archetype.animation[row];
+                writeInt(out, a.frameCount);
+                writeFloat(out, a.framesPerSecond);
+                writeFloat(out, a.startTime);
+            }
+            if (archetype.mask & ComponentTint) {
+                writeInt(out, (int)archetype.tint[row].rgba);
+            }
+        }
     }
 
     // Check if write operations succeeded
@@ -208,7 +273,7 @@ bool SceneSerializer::loadBinary(Scene& scene, const std::string& path)
     if (!in.is_open()) return false;
 
     int version = readInt(in);
-    if (version != 1) {
+    if (version < 1 || version > kBinaryVersion) {
         return false; // future proofing
     }
 
@@ -218,6 +283,7 @@ bool SceneSerializer::loadBinary(Scene& scene, const std::string& path)
     scene.grid.cellHeight = readFloat(in);
     scene.grid.rows = readInt(in);
     scene.grid.cols = readInt(in);
+    scene.grid.bounded = version >= 3 && readInt(in) != 0;
 
     int entityCount = readInt(in);
     scene.entities.clear();
@@ -225,11 +291,29 @@ bool SceneSerializer::loadBinary(Scene& scene, const std::string& path)
 
     for (int i = 0; i < entityCount; i++) {
         Entity e;
-        e.type = readString(in);
+        e.type = AssetRegistry::Intern(readString(in));
         e.x = readFloat(in);
         e.y = readFloat(in);
         e.layer = readInt(in);
-        scene.entities.push_back(e);
+
+        EntityComponents components;
+        if (version >= 2) {
+            components.mask = (uint32_t)readInt(in) & ComponentAll;
+            if (components.mask & ComponentCollision) {
+                components.collision.width = readFloat(in);
+                components.collision.height = readFloat(in);
+                components.collision.solid = readInt(in) != 0;
+            }
+            if (components.mask & ComponentAnimation) {
+                components.animation.frameCount = readInt(in);
+                components.animation.framesPerSecond = readFloat(in);
+                components.animation.startTime = readFloat(in);
+            }
+            if (components.mask & ComponentTint) {
+                components.tint.rgba = (uint32_t)readInt(in);
+            }
+        }
+        scene.entities.create(e, components);
     }
 
     return true;
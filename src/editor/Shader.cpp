@@ -1,8 +1,12 @@
 #include "Shader.h"
+#include "Hash.h"
 #include <fstream>
 #include <sstream>
 #include <iostream>
-#include <glad/glad.h>
+#include <filesystem>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
 #include <glm/gtc/type_ptr.hpp>
 
 std::string Shader::loadFile(const std::string& path) {
@@ -34,30 +38,164 @@ unsigned int Shader::compileStage(unsigned int type, const std::string& src) {
     return shader;
 }
 
+namespace {
+    const char* kCacheDir = "shader_cache";
+    constexpr uint32_t kCacheMagic = 0x42534754; // "TGSB"
+
+    struct CacheHeader {
+        uint32_t magic;
+        uint32_t format; // GLenum from glGetProgramBinary
+        uint64_t hash;
+        uint64_t length;
+    };
+
+    const char* glString(GLenum name) {
+        const GLubyte* value = glGetString(name);
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+
+    // Binaries need GL 4.1 / ARB_get_program_binary and a driver that offers at least one format
+    bool programBinarySupported() {
+        static int supported = -1;
+        if (supported < 0) {
+            bool api = GLAD_GL_VERSION_4_1 != 0;
+#ifdef GL_ARB_get_program_binary
+            api = api || GLAD_GL_ARB_get_program_binary != 0;
+#endif
+            GLint formats = 0;
+            if (api) glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+            supported = formats > 0 ? 1 : 0;
+        }
+        return supported == 1;
+    }
+}
+
 Shader::Shader(const std::string& vertPath, const std::string& fragPath) {
     std::string vertSrc = loadFile(vertPath);
     std::string fragSrc = loadFile(fragPath);
 
-    GLuint vs = compileStage(GL_VERTEX_SHADER, vertSrc);
-    GLuint fs = compileStage(GL_FRAGMENT_SHADER, fragSrc);
+    // Driver strings are part of the key: a binary is only valid for the driver that made it
+    uint64_t hash = Fnv1a64(vertSrc.data(), vertSrc.size());
+    hash = Fnv1a64("\0", 1, hash);
+    hash = Fnv1a64(fragSrc.data(), fragSrc.size(), hash);
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* value = glString(name);
+        hash = Fnv1a64(value, std::strlen(value), hash);
+    }
+
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "%016llx.bin", static_cast<unsigned long long>(hash));
+    std::string cachePath = (std::filesystem::path(kCacheDir) / fileName).string();
+
+    bool useCache = programBinarySupported();
+    if (!useCache || !loadBinary(cachePath, hash)) {
+        GLuint vs = compileStage(GL_VERTEX_SHADER, vertSrc);
+        GLuint fs = compileStage(GL_FRAGMENT_SHADER, fragSrc);
+
+        id = glCreateProgram();
+        glAttachShader(id, vs);
+        glAttachShader(id, fs);
+        if (useCache) glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        glLinkProgram(id);
+
+        GLint success;
+        glGetProgramiv(id, GL_LINK_STATUS, &success);
+        if (!success) {
+            char log[512];
+            glGetProgramInfoLog(id, 512, nullptr, log);
+            std::cerr << "Shader linking error: " << log << std::endl;
+        }
+        else if (useCache) {
+            saveBinary(cachePath, hash);
+        }
+
+        glDeleteShader(vs);
+        glDeleteShader(fs);
+    }
+
+    // Block bindings and uniform values are not part of the binary, so set them up either way
+    GLuint cameraBlock = glGetUniformBlockIndex(id, "Camera");
+    if (cameraBlock != GL_INVALID_INDEX)
+        glUniformBlockBinding(id, cameraBlock, kCameraBlockBinding);
+
+    reflect();
+}
+
+bool Shader::loadBinary(const std::string& cachePath, uint64_t hash) {
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file) return false;
+
+    CacheHeader header{};
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!file || header.magic != kCacheMagic || header.hash != hash || header.length == 0)
+        return false;
+
+    std::vector<char> binary(header.length);
+    file.read(binary.data(), binary.size());
+    if (!file) return false;
 
     id = glCreateProgram();
-    glAttachShader(id, vs);
-    glAttachShader(id, fs);
-    glLinkProgram(id);
+    glProgramBinary(id, header.format, binary.data(), static_cast<GLsizei>(binary.size()));
 
-    GLint success;
+    // The driver may still reject it (e.g. after an update that kept the version string)
+    GLint success = 0;
     glGetProgramiv(id, GL_LINK_STATUS, &success);
     if (!success) {
-        char log[512];
-        glGetProgramInfoLog(id, 512, nullptr, log);
-        std::cerr << "Shader linking error: " << log << std::endl;
+        glDeleteProgram(id);
+        id = 0;
+        return false;
+    }
+
+    m_fromCache = true;
+    return true;
+}
+
+void Shader::saveBinary(const std::string& cachePath, uint64_t hash) const {
+    GLint length = 0;
+    glGetProgramiv(id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(id, length, nullptr, &format, binary.data());
+
+    std::error_code error;
+    std::filesystem::create_directories(kCacheDir, error);
+    std::ofstream file(cachePath, std::ios::binary);
+    if (!file) {
+        std::cerr << "Shader: could not write cache file " << cachePath << std::endl;
+        return;
     }
 
-    glDeleteShader(vs);
-    glDeleteShader(fs);
+    CacheHeader header{ kCacheMagic, format, hash, static_cast<uint64_t>(length) };
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), binary.size());
 }
 
+void Shader::reflect() {
+    m_uniforms.clear();
+
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::vector<char> name(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++) {
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(id, static_cast<GLuint>(i), maxLength, nullptr, &size, &type, name.data());
+
+        // Uniform block members have no location, they are set through the block's buffer
+        GLint location = glGetUniformLocation(id, name.data());
+        if (location == -1) continue;
+
+        std::string uniformName = name.data();
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3);
+        m_uniforms.push_back({ std::move(uniformName), location, type, size });
+    }
+}
 
 Shader::~Shader() {
     if (id != 0) {
@@ -66,7 +204,7 @@ Shader::~Shader() {
 }
 
 Shader::Shader(Shader&& other) noexcept
-    : id(other.id)
+    : id(other.id), m_uniforms(std::move(other.m_uniforms)), m_fromCache(other.m_fromCache)
 {
     other.id = 0; // Transfer ownership, prevent double deletion
 }
@@ -78,6 +216,8 @@ Shader& Shader::operator=(Shader&& other) noexcept {
         }
         // Transfer ownership
         id = other.id;
+        m_uniforms = std::move(other.m_uniforms);
+        m_fromCache = other.m_fromCache;
         other.id = 0; // Prevent double deletion
     }
     return *this;
@@ -87,14 +227,34 @@ void Shader::use() const {
     glUseProgram(id);
 }
 
-void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(id, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+GLint Shader::location(const char* name) const {
+    // A handful of uniforms per program, a linear scan beats hashing the name
+    for (const Uniform& uniform : m_uniforms) {
+        if (uniform.name == name) return uniform.location;
+    }
+    return -1;
+}
+
+void Shader::setMat4(const char* name, const glm::mat4& mat) const {
+    glUniformMatrix4fv(location(name), 1, GL_FALSE, glm::value_ptr(mat));
+}
+
+void Shader::setVec2(const char* name, const glm::vec2& vec) const {
+    glUniform2f(location(name), vec.x, vec.y);
+}
+
+void Shader::setVec3(const char* name, const glm::vec3& vec) const {
+    glUniform3f(location(name), vec.x, vec.y, vec.z);
+}
+
+void Shader::setVec4(const char* name, const glm::vec4& vec) const {
+    glUniform4f(location(name), vec.x, vec.y, vec.z, vec.w);
 }
 
-void Shader::setVec3(const std::string& name, const glm::vec3& vec) const {
-    glUniform3f(glGetUniformLocation(id, name.c_str()), vec.x, vec.y, vec.z);
+void Shader::setFloat(const char* name, float value) const {
+    glUniform1f(location(name), value);
 }
 
-void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(id, name.c_str()), value);
+void Shader::setInt(const char* name, int value) const {
+    glUniform1i(location(name), value);
 }
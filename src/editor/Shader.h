@@ -1,9 +1,28 @@
 #pragma once
 #include <string>
+#include <vector>
+#include <cstdint>
+#include <glad/glad.h>
 #include <glm/glm.hpp>
 
+/**
+ * Shader: A linked vertex + fragment program. Linked binaries are cached in shader_cache/
+ * keyed by a hash of both sources and the driver, so warm starts skip compiling. After
+ * linking every active uniform is reflected into a small table: setters and location()
+ * look names up there and never ask GL. A "Camera" uniform block, if the program has
+ * one, is bound to kCameraBlockBinding (see CameraUniforms).
+ */
 class Shader {
 public:
+    static constexpr GLuint kCameraBlockBinding = 0;
+
+    struct Uniform {
+        std::string name; // Arrays without the "[0]" suffix
+        GLint location;
+        GLenum type;
+        GLint size;
+    };
+
     Shader() = default;
     Shader(const std::string& vertPath, const std::string& fragPath);
     ~Shader();
@@ -15,13 +34,33 @@ public:
     Shader& operator=(Shader&& other) noexcept;
 
     void use() const;
-    void setMat4(const std::string&, const glm::mat4&) const;
-    void setVec3(const std::string&, const glm::vec3&) const;
-    void setInt(const std::string&, int value) const;
+    void setMat4(const char* name, const glm::mat4&) const;
+    void setVec2(const char* name, const glm::vec2&) const;
+    void setVec3(const char* name, const glm::vec3&) const;
+    void setVec4(const char* name, const glm::vec4&) const;
+    void setFloat(const char* name, float value) const;
+    void setInt(const char* name, int value) const;
+
+    /**
+     * Location: Uniform location from the reflected table, -1 if the program has no
+     * active uniform of that name (e.g. the compiler optimized it out).
+     */
+    GLint location(const char* name) const;
+
+    const std::vector<Uniform>& uniforms() const { return m_uniforms; }
+
+    // True if the program came from shader_cache/ instead of being compiled
+    bool loadedFromCache() const { return m_fromCache; }
 
     unsigned int id = 0;
 
 private:
     std::string loadFile(const std::string& path);
     unsigned int compileStage(unsigned int type, const std::string& src);
+    bool loadBinary(const std::string& cachePath, uint64_t hash);
+    void saveBinary(const std::string& cachePath, uint64_t hash) const;
+    void reflect();
+
+    std::vector<Uniform> m_uniforms;
+    bool m_fromCache = false;
 };
@@ -0,0 +1,69 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+
+bool SpatialGrid::setCellSize(float cellWidth, float cellHeight) {
+    if (cellWidth == m_cellWidth && cellHeight == m_cellHeight) return false;
+    m_cellWidth = cellWidth;
+    m_cellHeight = cellHeight;
+    return true;
+}
+
+void SpatialGrid::clear() {
+    m_chunks.clear();
+    m_tileCount = 0;
+}
+
+void SpatialGrid::rebuild(const EntityStore& entities) {
+    clear();
+    for (auto& archetype : entities.archetypes()) {
+        for (size_t row = 0; row < archetype.size(); row++) {
+            m_chunks[keyFor(archetype.x[row], archetype.y[row])].push_back(archetype.index[row]);
+        }
+        m_tileCount += archetype.size();
+    }
+}
+
+int64_t SpatialGrid::keyFor(float x, float y) const {
+    int cx = static_cast<int>(std::floor(x / (m_cellWidth * kChunkCells)));
+    int cy = static_cast<int>(std::floor(y / (m_cellHeight * kChunkCells)));
+    return makeKey(cx, cy);
+}
+
+int64_t SpatialGrid::add(const Entity& entity) {
+    int64_t key = keyFor(entity.x, entity.y);
+    m_chunks[key].push_back(entity.handle.index);
+    m_tileCount++;
+    return key;
+}
+
+bool SpatialGrid::remove(const Entity& entity, int64_t& outKey) {
+    outKey = keyFor(entity.x, entity.y);
+    auto it = m_chunks.find(outKey);
+    if (it == m_chunks.end()) return false;
+
+    auto& tiles = it->second;
+    auto tile = std::find(tiles.begin(), tiles.end(), entity.handle.index);
+    if (tile == tiles.end()) return false;
+
+    tiles.erase(tile);
+    if (tiles.empty()) m_chunks.erase(it);
+    m_tileCount--;
+    return true;
+}
+
+ChunkRange SpatialGrid::rangeFor(const glm::vec4& rect) const {
+    float chunkW = m_cellWidth * kChunkCells;
+    float chunkH = m_cellHeight * kChunkCells;
+
+    ChunkRange range;
+    range.minX = static_cast<int>(std::floor((rect.x - m_cellWidth) / chunkW));
+    range.minY = static_cast<int>(std::floor((rect.y - m_cellHeight) / chunkH));
+    range.maxX = static_cast<int>(std::floor((rect.z + m_cellWidth) / chunkW));
+    range.maxY = static_cast<int>(std::floor((rect.w + m_cellHeight) / chunkH));
+    return range;
+}
+
+const std::vector<uint32_t>* SpatialGrid::tiles(int64_t key) const {
+    auto it = m_chunks.find(key);
+    return (it != m_chunks.end()) ? &it->second : nullptr;
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+#include "EntityStore.h"
+
+// Inclusive range of chunk coordinates
+struct ChunkRange {
+    int minX = 0, minY = 0;
+    int maxX = -1, maxY = -1;
+
+    bool operator==(const ChunkRange& o) const {
+        return minX == o.minX && minY == o.minY && maxX == o.maxX && maxY == o.maxY;
+    }
+    bool operator!=(const ChunkRange& o) const { return !(*this == o); }
+};
+
+/**
+ * SpatialGrid: Buckets tiles into kChunkCells x kChunkCells cell chunks, keyed by chunk
+ * coordinate in a hash map. Edits touch one bucket; queries walk only the chunks that
+ * overlap a world rect, so culling cost follows what is on screen, not the map size.
+ * Buckets hold entity indices (EntityHandle::index), 4 bytes a tile; the tiles' fields
+ * stay in the EntityStore and are read from there with EntityStore::entity().
+ */
+class SpatialGrid {
+public:
+    static constexpr int kChunkCells = 32;
+
+    static int64_t makeKey(int cx, int cy) {
+        return (static_cast<int64_t>(cx) << 32) | static_cast<uint32_t>(cy);
+    }
+
+    /**
+     * Set cell size: Chunk bounds follow the grid cell size. Returns true if it changed,
+     * in which case the caller must rebuild() so tiles land in the right chunks.
+     */
+    bool setCellSize(float cellWidth, float cellHeight);
+
+    void clear();
+    void rebuild(const EntityStore& entities);
+
+    /**
+     * Add / remove: Returns the key of the chunk that changed; the entity's position picks
+     * the chunk. remove() matches the tile by handle and returns false if it wasn't found.
+     */
+    int64_t add(const Entity& entity);
+    bool remove(const Entity& entity, int64_t& outKey);
+
+    int64_t keyFor(float x, float y) const;
+
+    /**
+     * Range for: Chunk coordinates overlapping a (left, bottom, right, top) world rect,
+     * padded by one cell so tiles straddling the edge are kept.
+     */
+    ChunkRange rangeFor(const glm::vec4& rect) const;
+
+    /**
+     * For each chunk: Calls fn(key, indices) for every non-empty chunk inside `range`.
+     * Falls back to walking the map when the range covers more slots than there are chunks.
+     */
+    template<typename Fn>
+    void forEachChunk(const ChunkRange& range, Fn&& fn) const {
+        int64_t width = static_cast<int64_t>(range.maxX) - range.minX + 1;
+        int64_t height = static_cast<int64_t>(range.maxY) - range.minY + 1;
+        if (width <= 0 || height <= 0) return;
+
+        if (width * height > static_cast<int64_t>(m_chunks.size())) {
+            for (auto& [key, tiles] : m_chunks) {
+                int cx = static_cast<int>(key >> 32);
+                int cy = static_cast<int>(static_cast<int32_t>(key & 0xffffffff));
+                if (cx >= range.minX && cx <= range.maxX && cy >= range.minY && cy <= range.maxY)
+                    fn(key, tiles);
+            }
+            return;
+        }
+
+        for (int cy = range.minY; cy <= range.maxY; cy++) {
+            for (int cx = range.minX; cx <= range.maxX; cx++) {
+                auto it = m_chunks.find(makeKey(cx, cy));
+                if (it != m_chunks.end())
+                    fn(it->first, it->second);
+            }
+        }
+    }
+
+    const std::vector<uint32_t>* tiles(int64_t key) const;
+
+    float getCellWidth() const { return m_cellWidth; }
+    float getCellHeight() const { return m_cellHeight; }
+    size_t chunkCount() const { return m_chunks.size(); }
+    size_t tileCount() const { return m_tileCount; }
+
+private:
+    std::unordered_map<int64_t, std::vector<uint32_t>> m_chunks;
+    float m_cellWidth = 16.0f;
+    float m_cellHeight = 16.0f;
+    size_t m_tileCount = 0;
+};
@@ -0,0 +1,136 @@
+#include "SpriteBatch.h"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+static constexpr int kFloatsPerVertex = 5; // pos.xy + tex.uv like Editor::m_quadVAO, + texture array layer
+static constexpr int kVerticesPerSprite = 4;
+static constexpr int kIndicesPerSprite = 6;
+
+SpriteBatch::~SpriteBatch() {
+    if (m_ebo) glDeleteBuffers(1, &m_ebo);
+    if (m_vao) glDeleteVertexArrays(1, &m_vao);
+}
+
+void SpriteBatch::init(StreamBuffer& stream, int maxSprites) {
+    m_stream = &stream;
+    m_maxSprites = maxSprites;
+
+    // Index pattern never changes, build it once: 0,1,2, 2,3,0 per quad
+    std::vector<GLuint> indices(static_cast<size_t>(maxSprites) * kIndicesPerSprite);
+    for (GLuint i = 0; i < static_cast<GLuint>(maxSprites); i++) {
+        GLuint base = i * kVerticesPerSprite;
+        GLuint* idx = &indices[i * kIndicesPerSprite];
+        idx[0] = base + 0; idx[1] = base + 1; idx[2] = base + 2;
+        idx[3] = base + 2; idx[4] = base + 3; idx[5] = base + 0;
+    }
+
+    glGenVertexArrays(1, &m_vao);
+    glGenBuffers(1, &m_ebo);
+
+    glBindVertexArray(m_vao);
+
+    // Attributes start at offset 0 of the stream buffer; each flush picks its base vertex
+    glBindBuffer(GL_ARRAY_BUFFER, m_stream->handle());
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(4 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+
+    glBindVertexArray(0);
+}
+
+void SpriteBatch::begin() {
+    m_sprites.clear();
+    m_queue.clear();
+    m_stats = RenderStats{};
+}
+
+void SpriteBatch::submit(GLuint texture, int layer, float x, float y, float w, float h, const glm::vec4& uvRect, float arrayLayer) {
+    m_queue.push(RenderQueue::makeKey(layer, 0, texture), static_cast<uint32_t>(m_sprites.size()));
+    m_sprites.push_back({ texture, x, y, w, h, uvRect, arrayLayer });
+}
+
+void SpriteBatch::end() {
+    if (m_sprites.empty()) return;
+
+    // Layer decides draw order, texture groups quads into as few draw calls as possible.
+    // The radix sort is stable, so ties keep submission order frame to frame.
+    m_queue.sort();
+
+    glBindVertexArray(m_vao);
+    glActiveTexture(GL_TEXTURE0);
+    m_boundTexture = 0;
+
+    for (size_t first = 0; first < m_sprites.size(); first += m_maxSprites) {
+        size_t count = std::min(m_sprites.size() - first, static_cast<size_t>(m_maxSprites));
+        flushRange(first, count);
+    }
+
+    m_stats.sprites = static_cast<int>(m_sprites.size());
+    m_stats.vertices = m_stats.sprites * kVerticesPerSprite;
+}
+
+void SpriteBatch::flushRange(size_t first, size_t count) {
+    // Quads are written straight into this frame's slice of the stream buffer
+    constexpr size_t kStride = kFloatsPerVertex * sizeof(float);
+    size_t bytes = count * kVerticesPerSprite * kStride;
+    size_t offset = 0;
+    float* dst = static_cast<float*>(m_stream->map(bytes, kStride, offset));
+    if (!dst) return;
+
+    const auto& order = m_queue.items();
+    for (size_t i = first; i < first + count; i++) {
+        const Sprite& s = m_sprites[order[i].index];
+        float x0 = s.x - s.w * 0.5f, x1 = s.x + s.w * 0.5f;
+        float y0 = s.y - s.h * 0.5f, y1 = s.y + s.h * 0.5f;
+
+        // Same winding and UV corners as the editor quad
+        float quad[] = {
+            x0, y0, s.uv.x, s.uv.y, s.arrayLayer,
+            x1, y0, s.uv.z, s.uv.y, s.arrayLayer,
+            x1, y1, s.uv.z, s.uv.w, s.arrayLayer,
+            x0, y1, s.uv.x, s.uv.w, s.arrayLayer
+        };
+        std::memcpy(dst, quad, sizeof(quad));
+        dst += std::size(quad);
+    }
+
+    m_stream->unmap();
+    m_stats.bytesUploaded += bytes;
+    GLint baseVertex = static_cast<GLint>(offset / kStride);
+
+    // One draw call per run of sprites sharing a texture
+    size_t runStart = 0;
+    while (runStart < count) {
+        GLuint texture = RenderQueue::keyTexture(order[first + runStart].key);
+        size_t runEnd = runStart + 1;
+        while (runEnd < count && RenderQueue::keyTexture(order[first + runEnd].key) == texture) {
+            runEnd++;
+        }
+
+        // Texture 0: array-layer quads, the caller keeps the array bound for the whole batch
+        if (texture != 0 && texture != m_boundTexture) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            m_boundTexture = texture;
+            m_stats.textureBinds++;
+        }
+
+        glDrawElementsBaseVertex(GL_TRIANGLES,
+            static_cast<GLsizei>((runEnd - runStart) * kIndicesPerSprite),
+            GL_UNSIGNED_INT,
+            (void*)(runStart * kIndicesPerSprite * sizeof(GLuint)),
+            baseVertex);
+        m_stats.drawCalls++;
+
+        runStart = runEnd;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+#include "RenderSettings.h"
+#include "RenderQueue.h"
+#include "StreamBuffer.h"
+
+class SpriteBatch {
+public:
+    SpriteBatch() = default;
+    ~SpriteBatch();
+
+    // Owns GL objects, so no copies
+    SpriteBatch(const SpriteBatch&) = delete;
+    SpriteBatch& operator=(const SpriteBatch&) = delete;
+
+    /**
+     * Init: Creates a static index buffer and a VAO over `stream` with the same
+     * layout as the editor quad (location 0 = vec2 position, location 1 = vec2 texcoord),
+     * plus location 2 = float texture array layer, which sprite.vert simply ignores.
+     * maxSprites is how many quads fit in one upload; bigger batches are split, and one
+     * upload must fit a stream buffer region.
+     */
+    void init(StreamBuffer& stream, int maxSprites = 16384);
+
+    /**
+     * Begin: Starts a new batch. Vertices are submitted in world space; the sprite shaders
+     * take the camera matrix from the shared Camera uniform block.
+     */
+    void begin();
+
+    /**
+     * Submit: Queues one world-space quad centered on (x, y). Nothing is drawn until end().
+     * Quads are drawn ordered by layer, and grouped by texture inside a layer.
+     * texture 0 means "sample arrayLayer of the texture array the caller bound", so those
+     * quads never cause a bind.
+     */
+    void submit(GLuint texture, int layer, float x, float y, float w, float h,
+        const glm::vec4& uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), float arrayLayer = -1.0f);
+
+    /**
+     * End: Sorts the queued quads, writes them into the vertex buffer and issues one
+     * draw call per texture run. Stats for the frame are available after this.
+     */
+    void end();
+
+    const RenderStats& getStats() const { return m_stats; }
+
+private:
+    struct Sprite {
+        GLuint texture;
+        float x, y, w, h;
+        glm::vec4 uv;
+        float arrayLayer;
+    };
+
+    void flushRange(size_t first, size_t count);
+
+    std::vector<Sprite> m_sprites;  // Submission order, never reordered
+    RenderQueue m_queue;            // Draw order: (layer, texture) key -> index into m_sprites
+    StreamBuffer* m_stream = nullptr;
+
+    GLuint m_vao = 0;
+    GLuint m_ebo = 0;
+    int m_maxSprites = 0;
+    GLuint m_boundTexture = 0;
+
+    RenderStats m_stats;
+};
@@ -0,0 +1,92 @@
+#include "StreamBuffer.h"
+#include <cstring>
+#include <iostream>
+
+StreamBuffer::~StreamBuffer() {
+    for (GLsync& fence : m_fences) {
+        if (fence) glDeleteSync(fence);
+    }
+    if (m_buffer) glDeleteBuffers(1, &m_buffer);
+}
+
+void StreamBuffer::init(size_t regionBytes, GLenum target) {
+    m_regionBytes = regionBytes;
+    m_target = target;
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(m_target, m_buffer);
+    glBufferData(m_target, static_cast<GLsizeiptr>(m_regionBytes * kRegions), nullptr, GL_STREAM_DRAW);
+}
+
+void* StreamBuffer::map(size_t bytes, size_t alignment, size_t& offset) {
+    if (bytes == 0 || bytes > m_regionBytes) {
+        if (bytes > m_regionBytes)
+            std::cerr << "StreamBuffer: " << bytes << " bytes don't fit a " << m_regionBytes << " byte region\n";
+        return nullptr;
+    }
+
+    // Alignment is a vertex stride, not necessarily a power of two
+    size_t regionStart = m_region * m_regionBytes;
+    size_t absolute = regionStart + m_head;
+    size_t aligned = (absolute + alignment - 1) / alignment * alignment;
+
+    if (aligned + bytes > regionStart + m_regionBytes) {
+        // This frame outgrew its region: continue in the next one (fenced like a frame end)
+        advanceRegion();
+        m_stats.regionOverflows++;
+        regionStart = m_region * m_regionBytes;
+        aligned = (regionStart + alignment - 1) / alignment * alignment;
+        if (aligned + bytes > regionStart + m_regionBytes) return nullptr;
+    }
+
+    m_head = aligned + bytes - regionStart;
+    offset = aligned;
+    m_stats.bytesWritten += bytes;
+
+    // Unsynchronized is safe: the region's fence was waited on before it was handed out
+    glBindBuffer(m_target, m_buffer);
+    return glMapBufferRange(m_target, static_cast<GLintptr>(aligned), static_cast<GLsizeiptr>(bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT);
+}
+
+void StreamBuffer::unmap() {
+    glBindBuffer(m_target, m_buffer);
+    glUnmapBuffer(m_target);
+}
+
+ptrdiff_t StreamBuffer::write(const void* data, size_t bytes, size_t alignment) {
+    size_t offset = 0;
+    void* dst = map(bytes, alignment, offset);
+    if (!dst) return -1;
+    std::memcpy(dst, data, bytes);
+    unmap();
+    return static_cast<ptrdiff_t>(offset);
+}
+
+void StreamBuffer::endFrame() {
+    advanceRegion();
+}
+
+void StreamBuffer::advanceRegion() {
+    // Nothing written into the region since we waited on it: no GPU reads left to guard
+    if (m_head > 0) {
+        if (m_fences[m_region]) glDeleteSync(m_fences[m_region]);
+        m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    m_region = (m_region + 1) % kRegions;
+    m_head = 0;
+
+    GLsync& fence = m_fences[m_region];
+    if (!fence) return;
+
+    // Usually signalled long ago (kRegions frames back); only block when the GPU lags
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status == GL_TIMEOUT_EXPIRED) {
+        m_stats.fenceWaits++;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms
+        } while (status == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+}
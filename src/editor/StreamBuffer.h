@@ -0,0 +1,72 @@
+#pragma once
+#include <glad/glad.h>
+#include <cstddef>
+
+/**
+ * StreamBuffer: One fixed-size GL buffer for geometry that is rewritten every frame.
+ * The storage is split into kRegions regions used round-robin, one per frame in flight.
+ * Writes map only the bytes they need (unsynchronized + invalidate range, so the driver
+ * never waits or copies), and every region is fenced when the frame that wrote it ends;
+ * reusing a region first waits on its fence, so the CPU never overwrites vertices the GPU
+ * is still reading. The buffer is allocated once in init() and never reallocated.
+ *
+ * Vertices by default; AssetManager also uses one on GL_PIXEL_UNPACK_BUFFER to stage
+ * texture uploads.
+ */
+class StreamBuffer {
+public:
+    static constexpr int kRegions = 3;
+
+    struct Stats {
+        size_t bytesWritten = 0;
+        int fenceWaits = 0;     // Region reuses that found the GPU not done yet
+        int regionOverflows = 0; // Frames that spilled into the next region early
+    };
+
+    StreamBuffer() = default;
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    /**
+     * Init: Allocates kRegions * regionBytes of storage on `target`.
+     */
+    void init(size_t regionBytes, GLenum target = GL_ARRAY_BUFFER);
+
+    /**
+     * Map: Reserves `bytes` in the current region at an offset that is a multiple of
+     * `alignment` (use the vertex stride, so offset / stride is a valid base vertex) and
+     * maps just that range. Returns nullptr if `bytes` is larger than a region. Must be
+     * followed by unmap() before drawing. Leaves the buffer bound to its target.
+     */
+    void* map(size_t bytes, size_t alignment, size_t& offset);
+    void unmap();
+
+    /**
+     * Write: map() + memcpy + unmap(). Returns the offset, or -1 if it didn't fit.
+     */
+    ptrdiff_t write(const void* data, size_t bytes, size_t alignment);
+
+    /**
+     * End frame: Fences the region written this frame and moves to the next one, waiting
+     * for the GPU if it is still using it. Called once per frame after the last draw.
+     */
+    void endFrame();
+
+    GLuint handle() const { return m_buffer; }
+    GLenum target() const { return m_target; }
+    const Stats& getStats() const { return m_stats; }
+    void resetStats() { m_stats = Stats{}; }
+
+private:
+    void advanceRegion();
+
+    GLuint m_buffer = 0;
+    GLenum m_target = GL_ARRAY_BUFFER;
+    size_t m_regionBytes = 0;
+    int m_region = 0;
+    size_t m_head = 0; // Next free byte inside the current region
+    GLsync m_fences[kRegions] = {};
+    Stats m_stats;
+};
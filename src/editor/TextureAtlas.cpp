@@ -0,0 +1,187 @@
+#include "TextureAtlas.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+TextureAtlas::TextureAtlas(const AtlasSettings& settings)
+    : m_settings(settings) {
+}
+
+void TextureAtlas::clear() {
+    m_pages.clear();
+    m_packers.clear();
+    m_regions.clear();
+    m_regionList.clear();
+}
+
+int TextureAtlas::build(const std::vector<std::pair<std::string, const TextureData*>>& textures) {
+    clear();
+
+    // Tallest first, then widest, then by name. The name tie-break keeps the layout
+    // identical no matter what order the folder scan or the hash map returned.
+    std::vector<std::pair<std::string, const TextureData*>> sorted;
+    sorted.reserve(textures.size());
+    for (auto& entry : textures) {
+        if (entry.second && entry.second->RGBA())
+            sorted.push_back(entry);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        if (a.second->height != b.second->height) return a.second->height > b.second->height;
+        if (a.second->width != b.second->width) return a.second->width > b.second->width;
+        return a.first < b.first;
+    });
+
+    const int border = m_settings.extrude;
+    const int pageSize = m_settings.pageSize;
+    int packed = 0;
+
+    for (auto& [name, texture] : sorted) {
+        int cellW = texture->width + border * 2 + m_settings.padding;
+        int cellH = texture->height + border * 2 + m_settings.padding;
+
+        if (cellW > pageSize || cellH > pageSize) {
+            std::cerr << "Atlas: " << name << " (" << texture->width << "x" << texture->height
+                << ") does not fit a " << pageSize << " page, skipping\n";
+            continue;
+        }
+
+        // First page with room wins, otherwise open a new one
+        int cellX = 0, cellY = 0;
+        size_t pageIndex = 0;
+        for (; pageIndex < m_packers.size(); pageIndex++) {
+            if (insert(m_packers[pageIndex], cellW, cellH, cellX, cellY))
+                break;
+        }
+        if (pageIndex == m_packers.size()) {
+            PagePacker packer;
+            packer.skyline.push_back({ 0, 0, pageSize });
+            m_packers.push_back(packer);
+
+            AtlasPage page;
+            page.width = pageSize;
+            page.height = pageSize;
+            page.pixels.assign(static_cast<size_t>(pageSize) * pageSize * 4, 0);
+            m_pages.push_back(std::move(page));
+
+            insert(m_packers.back(), cellW, cellH, cellX, cellY);
+        }
+
+        int x = cellX + border;
+        int y = cellY + border;
+        blit(m_pages[pageIndex], *texture, x, y);
+
+        AtlasRegion region;
+        region.index = static_cast<int>(m_regionList.size());
+        region.page = static_cast<int>(pageIndex);
+        region.x = x;
+        region.y = y;
+        region.width = texture->width;
+        region.height = texture->height;
+        region.u0 = static_cast<float>(x) / pageSize;
+        region.v0 = static_cast<float>(y) / pageSize;
+        region.u1 = static_cast<float>(x + texture->width) / pageSize;
+        region.v1 = static_cast<float>(y + texture->height) / pageSize;
+        m_regions[name] = region;
+        m_regionList.push_back(region);
+        packed++;
+    }
+
+    return packed;
+}
+
+const AtlasRegion* TextureAtlas::find(const std::string& name) const {
+    auto it = m_regions.find(name);
+    return (it != m_regions.end()) ? &it->second : nullptr;
+}
+
+// Returns the y a width x height rect would rest at if its left edge is placed on
+// skyline node `index`, or -1 if it would stick out of the page.
+int TextureAtlas::fitAt(const PagePacker& packer, size_t index, int width, int height) const {
+    const int pageSize = m_settings.pageSize;
+    int x = packer.skyline[index].x;
+    if (x + width > pageSize) return -1;
+
+    int y = 0;
+    int widthLeft = width;
+    for (size_t i = index; widthLeft > 0; i++) {
+        if (i >= packer.skyline.size()) return -1;
+        y = std::max(y, packer.skyline[i].y);
+        if (y + height > pageSize) return -1;
+        widthLeft -= packer.skyline[i].width;
+    }
+    return y;
+}
+
+bool TextureAtlas::insert(PagePacker& packer, int width, int height, int& outX, int& outY) const {
+    // Bottom-left rule: lowest resulting top edge, then leftmost
+    int bestIndex = -1;
+    int bestTop = 0;
+    int bestX = 0, bestY = 0;
+
+    for (size_t i = 0; i < packer.skyline.size(); i++) {
+        int y = fitAt(packer, i, width, height);
+        if (y < 0) continue;
+
+        int top = y + height;
+        if (bestIndex < 0 || top < bestTop || (top == bestTop && packer.skyline[i].x < bestX)) {
+            bestIndex = static_cast<int>(i);
+            bestTop = top;
+            bestX = packer.skyline[i].x;
+            bestY = y;
+        }
+    }
+
+    if (bestIndex < 0) return false;
+
+    auto& skyline = packer.skyline;
+    skyline.insert(skyline.begin() + bestIndex, { bestX, bestY + height, width });
+
+    // Trim or remove the nodes now covered by the new one
+    for (size_t i = bestIndex + 1; i < skyline.size(); i++) {
+        const SkylineNode& prev = skyline[i - 1];
+        SkylineNode& node = skyline[i];
+        int prevRight = prev.x + prev.width;
+        if (node.x >= prevRight) break;
+
+        int shrink = prevRight - node.x;
+        node.x += shrink;
+        node.width -= shrink;
+        if (node.width > 0) break;
+
+        skyline.erase(skyline.begin() + i);
+        i--;
+    }
+
+    // Merge neighbours at the same height
+    for (size_t i = 0; i + 1 < skyline.size(); i++) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+            i--;
+        }
+    }
+
+    outX = bestX;
+    outY = bestY;
+    return true;
+}
+
+// Copies src into the page at (x, y) and repeats its outermost pixels `extrude`
+// times in every direction so bilinear/mip sampling never reads a neighbour.
+void TextureAtlas::blit(AtlasPage& page, const TextureData& src, int x, int y) const {
+    const int border = m_settings.extrude;
+
+    for (int row = -border; row < src.height + border; row++) {
+        int srcRow = std::clamp(row, 0, src.height - 1);
+        unsigned char* dst = &page.pixels[(static_cast<size_t>(y + row) * page.width + (x - border)) * 4];
+        const unsigned char* srcLine = src.RGBA() + static_cast<size_t>(srcRow) * src.width * 4;
+
+        // Left extrusion, body, right extrusion
+        for (int i = 0; i < border; i++, dst += 4)
+            std::memcpy(dst, srcLine, 4);
+        std::memcpy(dst, srcLine, static_cast<size_t>(src.width) * 4);
+        dst += static_cast<size_t>(src.width) * 4;
+        for (int i = 0; i < border; i++, dst += 4)
+            std::memcpy(dst, srcLine + (src.width - 1) * 4, 4);
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "TextureData.h"
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+struct AtlasSettings {
+    int pageSize = 1024; // Width and height of every page, in pixels
+    int padding = 1;     // Empty gap between two packed sprites
+    int extrude = 1;     // Border of repeated edge pixels around each sprite (stops filtering bleed)
+};
+
+// Where one packed texture ended up. uv* are normalized page coordinates of the
+// original pixels (no padding/extrusion), ready to feed to a sprite quad.
+struct AtlasRegion {
+    int index = -1; // Position in getRegionList(), stable for a given input set
+    int page = -1;
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+};
+
+struct AtlasPage {
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels; // RGBA8, same row order as TextureData
+};
+
+/**
+ * TextureAtlas: Packs CPU TextureData into one or more RGBA pages with a skyline
+ * bottom-left packer. Pure CPU code (no GL calls), and the result only depends on
+ * the input names and sizes, so the same folder always produces the same pages.
+ */
+class TextureAtlas {
+public:
+    explicit TextureAtlas(const AtlasSettings& settings = {});
+
+    /**
+     * Build: Packs every texture in `textures` (name -> data). Textures that cannot fit
+     * a page, or have no pixels, are skipped and keep using their own GL texture.
+     * Returns the number of textures packed.
+     */
+    int build(const std::vector<std::pair<std::string, const TextureData*>>& textures);
+
+    /**
+     * Clear: Drops all pages and regions.
+     */
+    void clear();
+
+    /**
+     * Find: Returns the region of a packed texture, or nullptr if it isn't in the atlas.
+     */
+    const AtlasRegion* find(const std::string& name) const;
+
+    const std::vector<AtlasPage>& getPages() const { return m_pages; }
+    const std::unordered_map<std::string, AtlasRegion>& getRegions() const { return m_regions; }
+    const std::vector<AtlasRegion>& getRegionList() const { return m_regionList; }
+    const AtlasSettings& getSettings() const { return m_settings; }
+
+private:
+    // One horizontal segment of the skyline: the packed height at [x, x + width)
+    struct SkylineNode {
+        int x, y, width;
+    };
+
+    struct PagePacker {
+        std::vector<SkylineNode> skyline;
+    };
+
+    bool insert(PagePacker& packer, int width, int height, int& outX, int& outY) const;
+    int fitAt(const PagePacker& packer, size_t index, int width, int height) const;
+    void blit(AtlasPage& page, const TextureData& src, int x, int y) const;
+
+    AtlasSettings m_settings;
+    std::vector<AtlasPage> m_pages;
+    std::vector<PagePacker> m_packers;
+    std::unordered_map<std::string, AtlasRegion> m_regions;
+    std::vector<AtlasRegion> m_regionList;
+};
@@ -1,19 +1,61 @@
 #include "TextureData.h"
+#include "Hash.h"
+#include "ImageKernels.h"
 #include "../../vendor/stb_image.h"
 #include <iostream>
+#include <fstream>
+#include <algorithm>
 
-bool TextureData::LoadFromFile(const std::string& path) {
-    stbi_set_flip_vertically_on_load(true);
+namespace {
+    constexpr uint32_t kCacheMagic = 0x43424754; // "TGBC"
+    constexpr uint32_t kCacheVersion = 1;        // Bump when the encoder's output changes
 
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    struct CompressedCacheHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t format;
+        int32_t width;
+        int32_t height;
+        uint32_t reserved;
+        uint64_t sourceHash;
+        uint64_t dataBytes;
+    };
+}
+
+bool TextureData::LoadFromFile(const std::string& path, PixelArena* arena) {
+    // The file's bytes and everything stb_image allocates come from this thread's scratch
+    // arena, rewound on return
+    PixelArena::ScratchScope scratch;
+
+    // Read the file ourselves so its bytes can be hashed for the compressed cache
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    std::streamoff fileBytes = file ? static_cast<std::streamoff>(file.tellg()) : 0;
+    PixelBuffer bytes(fileBytes > 0 ? static_cast<size_t>(fileBytes) : 0, scratch.arena());
+    file.seekg(0);
+    if (!bytes.empty() && !file.read(reinterpret_cast<char*>(bytes.data()), bytes.size())) bytes.clear();
+    sourceHash = Fnv1a64(bytes.data(), bytes.size());
+
+    // Decoded with the file's own channel count; the expansion to RGBA happens below
+    unsigned char* data = stbi_load_from_memory(bytes.data(), static_cast<int>(bytes.size()), &width, &height, &channels, 0);
     if (!data) {
         std::cerr << "Failed to load texture: " << path << "\n";
         return false;
     }
 
-    // Copy to vector (CPU memory)
-    size_t dataSize = width * height * 4;
-    pixels.assign(data, data + dataSize);
+    // Copy to vector (CPU memory) as RGBA8, bottom row first for GL, in one pass. Flipped here
+    // rather than with stbi_set_flip_vertically_on_load, which is a process-wide flag and this
+    // runs on several decode threads at once.
+    size_t rowBytes = static_cast<size_t>(width) * 4;
+    pixels = PixelBuffer(rowBytes * height, arena);
+    if (channels == 4) {
+        ImageKernels::FlipVertical(data, pixels.data(), rowBytes, height);
+    }
+    else {
+        size_t srcRowBytes = static_cast<size_t>(width) * channels;
+        for (int y = 0; y < height; y++) {
+            ImageKernels::ExpandToRGBA(data + srcRowBytes * (height - 1 - y), channels, pixels.data() + rowBytes * y, width);
+        }
+    }
 
     stbi_image_free(data);
     filepath = path;
@@ -21,9 +63,68 @@ bool TextureData::LoadFromFile(const std::string& path) {
     return true;
 }
 
+bool TextureData::LoadOrBuildCompressed() {
+    if (pixels.empty()) return false;
+
+    std::string cachePath = filepath + ".bcache";
+    BlockFormat format = BlockCompressor::ChooseFormat(pixels.data(), width, height);
+    size_t expectedBytes = BlockCompressor::EncodedSize(width, height, format);
+
+    std::ifstream in(cachePath, std::ios::binary);
+    if (in) {
+        CompressedCacheHeader header{};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (in && header.magic == kCacheMagic && header.version == kCacheVersion &&
+            header.sourceHash == sourceHash && header.format == static_cast<uint32_t>(format) &&
+            header.width == width && header.height == height && header.dataBytes == expectedBytes) {
+            compressed.resize(expectedBytes);
+            in.read(reinterpret_cast<char*>(compressed.data()), compressed.size());
+            if (in) {
+                compressedFormat = format;
+                return true;
+            }
+        }
+        compressed.clear();
+    }
+
+    compressed = BlockCompressor::Encode(pixels.data(), width, height, format);
+    compressedFormat = format;
+
+    std::ofstream out(cachePath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Could not write compressed cache: " << cachePath << "\n";
+        return true; // Still usable this run
+    }
+    CompressedCacheHeader header{ kCacheMagic, kCacheVersion, static_cast<uint32_t>(format), width, height, 0,
+        sourceHash, static_cast<uint64_t>(compressed.size()) };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(compressed.data()), compressed.size());
+    std::cout << "Compressed texture: " << filepath << " (" << (format == BlockFormat::BC1 ? "BC1" : "BC3") << ")\n";
+    return true;
+}
+
+const unsigned char* TextureData::RGBA() const {
+    if (!pixels.empty()) return pixels.data();
+    return mappedLevels.empty() ? nullptr : mappedLevels[0].data;
+}
+
+const unsigned char* TextureData::CompressedData() const {
+    return compressed.empty() ? mappedCompressed : compressed.data();
+}
+
+size_t TextureData::CompressedBytes() const {
+    return compressed.empty() ? mappedCompressedBytes : compressed.size();
+}
+
 void TextureData::FreeCPUData() {
     pixels.clear();
-    pixels.shrink_to_fit();
+    mips.clear();
+    mips.shrink_to_fit();
+    compressed.clear();
+    compressed.shrink_to_fit();
+    mappedLevels.clear();
+    mappedCompressed = nullptr;
+    mappedCompressedBytes = 0;
 }
 
 TextureData TextureLoader::Load(const std::string& path) {
@@ -36,9 +137,26 @@ bool TextureLoader::IsPowerOfTwo(int value) {
     return value > 0 && (value & (value - 1)) == 0;
 }
 
-TextureData TextureLoader::GenerateMipmapsCPU(const TextureData& source) {
-    // Placeholder for CPU-side mipmap generation if needed
-    // For now, we'll let OpenGL generate mipmaps on GPU
-    return source;
+void TextureLoader::GenerateMipmapsCPU(TextureData& texture) {
+    texture.mips.clear();
+    if (texture.pixels.empty()) return;
+
+    int levels = 0;
+    for (int size = std::max(texture.width, texture.height); size > 1; size = ImageKernels::NextMipSize(size)) levels++;
+    texture.mips.reserve(levels);
+
+    const unsigned char* level = texture.pixels.data();
+    int width = texture.width;
+    int height = texture.height;
+    while (width > 1 || height > 1) {
+        int nextWidth = ImageKernels::NextMipSize(width);
+        int nextHeight = ImageKernels::NextMipSize(height);
+        PixelBuffer next(static_cast<size_t>(nextWidth) * nextHeight * 4, texture.pixels.arena());
+        ImageKernels::Downsample2x(level, width, height, next.data());
+        texture.mips.push_back(std::move(next));
+        level = texture.mips.back().data();
+        width = nextWidth;
+        height = nextHeight;
+    }
 }
 
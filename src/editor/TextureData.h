@@ -2,15 +2,50 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include "BlockCompression.h"
+#include "PixelArena.h"
 
 struct TextureData {
     int width = 0;
     int height = 0;
     int channels = 0;
-    std::vector<unsigned char> pixels;
+    PixelBuffer pixels;
+    std::vector<PixelBuffer> mips; // Levels 1..n of `pixels`, empty unless GenerateMipmapsCPU ran
     std::string filepath;
+    uint64_t sourceHash = 0; // Hash of the image file's bytes, keys caches built from it
+
+    // Block-compressed copy of `pixels` (level 0 only), empty unless LoadOrBuildCompressed() ran
+    BlockFormat compressedFormat = BlockFormat::None;
+    std::vector<unsigned char> compressed;
+
+    // Set instead of `pixels` / `compressed` when the texture comes from a mapped AssetPack:
+    // views straight into the mapping, valid while the pack stays open
+    struct MappedLevel {
+        const unsigned char* data = nullptr;
+        int width = 0;
+        int height = 0;
+    };
+    std::vector<MappedLevel> mappedLevels; // RGBA8 mip chain, level 0 first, same row order as `pixels`
+    const unsigned char* mappedCompressed = nullptr;
+    size_t mappedCompressedBytes = 0;
+
+    // Level 0 as RGBA8, owned or mapped; nullptr once FreeCPUData() ran
+    const unsigned char* RGBA() const;
+    // Block-compressed level 0, owned or mapped (0 bytes if there is none)
+    const unsigned char* CompressedData() const;
+    size_t CompressedBytes() const;
+
+    // With an arena, `pixels` (and later `mips`) are carved from it; otherwise heap blocks
+    bool LoadFromFile(const std::string& path, PixelArena* arena = nullptr);
+
+    /**
+     * Load or build compressed: Reads <filepath>.bcache if it was built from the same source
+     * bytes, otherwise encodes `pixels` (BC1 if opaque, BC3 if not) and writes the cache.
+     * Needs `pixels`, so call it before FreeCPUData().
+     */
+    bool LoadOrBuildCompressed();
 
-    bool LoadFromFile(const std::string& path);
     void FreeCPUData();
 };
 
@@ -18,6 +53,8 @@ class TextureLoader {
 public:
     static TextureData Load(const std::string& path);
     static bool IsPowerOfTwo(int value);
-    static TextureData GenerateMipmapsCPU(const TextureData& source);
+    // Fills texture.mips down to 1x1 from `pixels` (2x2 box filter), so the upload doesn't
+    // need glGenerateMipmap. Runs fine on a decode thread. Levels share `pixels`' arena.
+    static void GenerateMipmapsCPU(TextureData& texture);
 };
 
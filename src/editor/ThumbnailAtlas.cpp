@@ -0,0 +1,110 @@
+#include "ThumbnailAtlas.h"
+#include "ImageKernels.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    struct Level {
+        const unsigned char* data;
+        int width;
+        int height;
+    };
+
+    // The source's RGBA8 mip chain, level 0 first, whichever form it is in
+    std::vector<Level> levelsOf(const TextureData& source) {
+        std::vector<Level> levels;
+        if (!source.mappedLevels.empty()) {
+            for (auto& level : source.mappedLevels) levels.push_back({ level.data, level.width, level.height });
+            return levels;
+        }
+        if (source.pixels.empty()) return levels;
+
+        int width = source.width;
+        int height = source.height;
+        levels.push_back({ source.pixels.data(), width, height });
+        for (auto& mip : source.mips) {
+            width = ImageKernels::NextMipSize(width);
+            height = ImageKernels::NextMipSize(height);
+            levels.push_back({ mip.data(), width, height });
+        }
+        return levels;
+    }
+}
+
+size_t ThumbnailAtlas::layout(size_t count, int maxSize) {
+    maxSize = std::max(maxSize, 256);
+    int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count + 1))));
+    int size = 256;
+    while (size < columns * kCellSize && size < maxSize) size *= 2;
+
+    m_size = std::min(size, maxSize);
+    m_columns = m_size / kCellSize;
+    return std::min(count, capacity());
+}
+
+void ThumbnailAtlas::clear() {
+    m_size = 0;
+    m_columns = 0;
+}
+
+size_t ThumbnailAtlas::capacity() const {
+    size_t cells = static_cast<size_t>(m_columns) * m_columns;
+    return cells > 0 ? cells - 1 : 0;
+}
+
+void ThumbnailAtlas::cellOrigin(int cell, int& x, int& y) const {
+    x = (cell % m_columns) * kCellSize;
+    y = (cell / m_columns) * kCellSize;
+}
+
+ThumbnailUV ThumbnailAtlas::uv(int cell) const {
+    int x, y;
+    cellOrigin(cell, x, y);
+    float scale = 1.0f / static_cast<float>(m_size);
+    return { x * scale, y * scale, (x + kCellSize) * scale, (y + kCellSize) * scale };
+}
+
+std::vector<unsigned char> ThumbnailAtlas::MakeThumbnail(const TextureData& source) {
+    std::vector<unsigned char> cell(static_cast<size_t>(kCellSize) * kCellSize * 4, 0);
+    std::vector<Level> levels = levelsOf(source);
+    if (levels.empty()) return cell;
+
+    Level level = levels[0];
+    for (const Level& candidate : levels) {
+        if (std::max(candidate.width, candidate.height) < kCellSize) break;
+        level = candidate;
+    }
+
+    // Fit inside the cell, aspect kept
+    float scale = static_cast<float>(kCellSize) / std::max(level.width, level.height);
+    int width = std::clamp(static_cast<int>(std::lround(level.width * scale)), 1, kCellSize);
+    int height = std::clamp(static_cast<int>(std::lround(level.height * scale)), 1, kCellSize);
+    int offsetX = (kCellSize - width) / 2;
+    int offsetY = (kCellSize - height) / 2;
+
+    for (int y = 0; y < height; y++) {
+        // Source rows [y0, y1) land on this row: one row when scaling up, a box when down
+        int y0 = y * level.height / height;
+        int y1 = std::max(y0 + 1, (y + 1) * level.height / height);
+        for (int x = 0; x < width; x++) {
+            int x0 = x * level.width / width;
+            int x1 = std::max(x0 + 1, (x + 1) * level.width / width);
+
+            unsigned int sum[4] = { 0, 0, 0, 0 };
+            for (int sy = y0; sy < y1; sy++) {
+                const unsigned char* row = level.data + (static_cast<size_t>(sy) * level.width + x0) * 4;
+                for (int sx = x0; sx < x1; sx++, row += 4) {
+                    for (int c = 0; c < 4; c++) sum[c] += row[c];
+                }
+            }
+            unsigned int count = static_cast<unsigned int>((y1 - y0) * (x1 - x0));
+            unsigned char* out = cell.data() + (static_cast<size_t>(offsetY + y) * kCellSize + offsetX + x) * 4;
+            for (int c = 0; c < 4; c++) out[c] = static_cast<unsigned char>((sum[c] + count / 2) / count);
+        }
+    }
+    return cell;
+}
+
+std::vector<unsigned char> ThumbnailAtlas::WhiteCell() {
+    return std::vector<unsigned char>(static_cast<size_t>(kCellSize) * kCellSize * 4, 255);
+}
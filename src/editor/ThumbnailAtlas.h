@@ -0,0 +1,49 @@
+#pragma once
+
+#include "TextureData.h"
+#include <vector>
+#include <cstddef>
+
+// Normalized rect of one cell, in TextureData row order (v0 is the bottom row)
+struct ThumbnailUV {
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+};
+
+/**
+ * ThumbnailAtlas: Layout of the palette's thumbnail texture, a square grid of kCellSize
+ * cells with one thumbnail each, and the downscaling that fills a cell. Pure CPU code like
+ * TextureAtlas; AssetManager owns the GL texture and uploads cells as they are made.
+ * Cell 0 is solid white, so frames and highlights can be drawn from the same texture.
+ */
+class ThumbnailAtlas {
+public:
+    static constexpr int kCellSize = 48; // Drawn 1:1 in the palette
+    static constexpr int kWhiteCell = 0;
+
+    /**
+     * Layout: Smallest power-of-two square (at least 256, at most maxSize) with a cell for
+     * each of `count` thumbnails plus the white one. Returns how many thumbnails fit.
+     */
+    size_t layout(size_t count, int maxSize);
+    void clear();
+
+    int size() const { return m_size; }
+    size_t capacity() const; // Thumbnails, not counting the white cell
+
+    // Top-left texel of a cell; thumbnail i lives in cell i + 1
+    void cellOrigin(int cell, int& x, int& y) const;
+    ThumbnailUV uv(int cell) const;
+
+    /**
+     * Make thumbnail: kCellSize x kCellSize RGBA8 of `source` scaled to fit with its aspect
+     * kept, centred on transparent. Starts from the smallest mip level (owned or mapped)
+     * that is still at least a cell wide; box filters down, nearest up (pixel art stays
+     * crisp). Safe on a worker thread.
+     */
+    static std::vector<unsigned char> MakeThumbnail(const TextureData& source);
+    static std::vector<unsigned char> WhiteCell();
+
+private:
+    int m_size = 0;
+    int m_columns = 0;
+};
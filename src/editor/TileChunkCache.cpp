@@ -0,0 +1,311 @@
+#include "TileChunkCache.h"
+#include "AssetManager.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+static constexpr int kFloatsPerVertex = 4; // pos.xy + tex.uv, same layout as the sprite batch
+static constexpr int kFloatsPerQuad = kFloatsPerVertex * 4;
+static constexpr int kMaxUploadsPerFrame = 64; // Spreads a big load over frames instead of one long hitch
+static constexpr uint32_t kAssetRun = 1; // Key's shader field: the texture field holds an AssetId, not a GL handle
+
+// Groups atlas tiles by page and the others by asset, whose handle is only known at draw time
+static uint64_t runKey(int layer, GLuint texture, AssetId asset) {
+    return asset != kNoAsset ? RenderQueue::makeKey(layer, kAssetRun, asset) : RenderQueue::makeKey(layer, 0, texture);
+}
+
+TileChunkCache::TileChunkCache(WorkerPool& workers)
+    : m_workers(workers), m_mailbox(std::make_shared<Mailbox>())
+{
+}
+
+TileChunkCache::~TileChunkCache() {
+    clear();
+    if (m_ebo) glDeleteBuffers(1, &m_ebo);
+}
+
+void TileChunkCache::clear() {
+    for (auto& [key, chunk] : m_chunks) {
+        destroyMeshes(chunk);
+    }
+    m_chunks.clear();
+    m_invalidated.clear();
+    m_drawList.clear();
+    m_drawListDirty = true;
+    m_epoch++;
+}
+
+void TileChunkCache::invalidate(int64_t key) {
+    auto it = m_chunks.find(key);
+    if (it == m_chunks.end()) return;
+
+    // Keep drawing the old mesh until the rebuilt one is uploaded
+    it->second.generation = ++m_nextGeneration;
+    m_invalidated.push_back(key);
+}
+
+void TileChunkCache::dropEmptiedChunks(const SpatialGrid& grid) {
+    // The grid erases a chunk with its last tile, so draw() would never visit it again
+    // and its old meshes would stay in the draw list
+    for (int64_t key : m_invalidated) {
+        if (grid.tiles(key)) continue;
+        auto it = m_chunks.find(key);
+        if (it == m_chunks.end()) continue;
+
+        destroyMeshes(it->second);
+        m_chunks.erase(it); // A job still in flight for it is dropped on arrival
+        m_drawListDirty = true;
+    }
+    m_invalidated.clear();
+}
+
+void TileChunkCache::destroyMeshes(Chunk& chunk) {
+    for (auto& mesh : chunk.meshes) {
+        glDeleteBuffers(1, &mesh.vbo);
+        glDeleteVertexArrays(1, &mesh.vao);
+    }
+    chunk.meshes.clear();
+}
+
+void TileChunkCache::ensureIndexCapacity(size_t quads) {
+    if (quads <= m_eboQuads) return;
+
+    // Round up so a few more tiles don't trigger another resize
+    size_t capacity = std::max(quads, std::max<size_t>(m_eboQuads * 2, SpatialGrid::kChunkCells * SpatialGrid::kChunkCells));
+    std::vector<GLuint> indices(capacity * 6);
+    for (GLuint i = 0; i < static_cast<GLuint>(capacity); i++) {
+        GLuint base = i * 4;
+        GLuint* idx = &indices[i * 6];
+        idx[0] = base + 0; idx[1] = base + 1; idx[2] = base + 2;
+        idx[3] = base + 2; idx[4] = base + 3; idx[5] = base + 0;
+    }
+
+    if (m_ebo == 0) glGenBuffers(1, &m_ebo);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+    m_eboQuads = capacity;
+}
+
+// Runs on a worker thread: no GL, only AssetManager lookups (which lock), AssetRegistry paths and the job's own buffers
+void TileChunkCache::generateChunk(const std::vector<Entity>& tiles, float cellWidth, float cellHeight, BuildResult& result) {
+    struct Resolved {
+        GLuint texture = 0;
+        AssetId asset = kNoAsset;
+        glm::vec4 uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    };
+
+    // Resolve textures once per type for this chunk
+    std::unordered_map<AssetId, Resolved> resolved;
+    std::vector<glm::vec4> uvs;
+    uvs.reserve(tiles.size());
+    RenderQueue queue;
+    queue.reserve(tiles.size());
+
+    for (size_t i = 0; i < tiles.size(); i++) {
+        const Entity& tile = tiles[i];
+        auto [it, inserted] = resolved.try_emplace(tile.type);
+        if (inserted) {
+            const std::string& path = AssetRegistry::Path(tile.type);
+            if (const AtlasRegion* region = AssetManager::GetAtlasRegion(path)) {
+                it->second.texture = AssetManager::GetAtlasPageHandle(region->page);
+                it->second.uv = glm::vec4(region->u0, region->v0, region->u1, region->v1);
+            }
+            if (it->second.texture == 0) {
+                // Own texture: may not be resident yet, or get evicted, so only the asset is kept
+                it->second.asset = tile.type;
+                it->second.uv = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            }
+        }
+        uvs.push_back(it->second.uv);
+        queue.push(runKey(tile.layer, it->second.texture, it->second.asset), static_cast<uint32_t>(i));
+    }
+    queue.sort();
+
+    // Every quad goes into the one staging buffer; runs of equal key become meshes
+    const auto& order = queue.items();
+    result.vertices.clear();
+    result.vertices.reserve(order.size() * kFloatsPerQuad);
+    result.runs.clear();
+
+    for (size_t i = 0; i < order.size(); i++) {
+        if (i == 0 || order[i].key != order[i - 1].key) {
+            uint64_t key = order[i].key;
+            bool asset = RenderQueue::keyShader(key) == kAssetRun;
+            result.runs.push_back({ RenderQueue::keyLayer(key), asset ? 0 : RenderQueue::keyTexture(key),
+                asset ? static_cast<AssetId>(RenderQueue::keyTexture(key)) : kNoAsset, i, 0 });
+        }
+        result.runs.back().quadCount++;
+
+        const Entity& tile = tiles[order[i].index];
+        const glm::vec4& uv = uvs[order[i].index];
+        float x0 = tile.x - cellWidth * 0.5f, x1 = tile.x + cellWidth * 0.5f;
+        float y0 = tile.y - cellHeight * 0.5f, y1 = tile.y + cellHeight * 0.5f;
+        float verts[] = {
+            x0, y0, uv.x, uv.y,
+            x1, y0, uv.z, uv.y,
+            x1, y1, uv.z, uv.w,
+            x0, y1, uv.x, uv.w
+        };
+        result.vertices.insert(result.vertices.end(), std::begin(verts), std::end(verts));
+    }
+}
+
+void TileChunkCache::queueChunk(int64_t key, Chunk& chunk, std::vector<Entity> tiles, float cellWidth, float cellHeight) {
+    chunk.queuedGeneration = chunk.generation;
+
+    BuildResult job;
+    job.key = key;
+    job.generation = chunk.generation;
+    job.epoch = m_epoch;
+    {
+        std::lock_guard<std::mutex> lock(m_mailbox->mutex);
+        if (!m_mailbox->stagingPool.empty()) {
+            job.vertices = std::move(m_mailbox->stagingPool.back());
+            m_mailbox->stagingPool.pop_back();
+        }
+    }
+
+    // The job owns its snapshot: the store keeps changing on the main thread while it runs
+    m_workers.submit([mailbox = m_mailbox, tiles = std::move(tiles), cellWidth, cellHeight, job = std::move(job)]() mutable {
+        {
+            PROFILE_SCOPE("Chunk vertices");
+            generateChunk(tiles, cellWidth, cellHeight, job);
+        }
+        std::lock_guard<std::mutex> lock(mailbox->mutex);
+        mailbox->finished.push_back(std::move(job));
+    });
+    m_pendingJobs++;
+}
+
+void TileChunkCache::uploadChunk(Chunk& chunk, BuildResult& result) {
+    destroyMeshes(chunk);
+
+    size_t largestRun = 0;
+    for (auto& run : result.runs) largestRun = std::max(largestRun, run.quadCount);
+    ensureIndexCapacity(largestRun);
+
+    for (auto& run : result.runs) {
+        Mesh mesh;
+        mesh.layer = run.layer;
+        mesh.texture = run.texture;
+        mesh.asset = run.asset;
+        mesh.indexCount = static_cast<GLsizei>(run.quadCount * 6);
+
+        glGenVertexArrays(1, &mesh.vao);
+        glGenBuffers(1, &mesh.vbo);
+        glBindVertexArray(mesh.vao);
+
+        size_t bytes = run.quadCount * kFloatsPerQuad * sizeof(float);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBufferData(GL_ARRAY_BUFFER, bytes, result.vertices.data() + run.firstQuad * kFloatsPerQuad, GL_STATIC_DRAW);
+        m_stats.bytesUploaded += bytes;
+
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ebo);
+
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, kFloatsPerVertex * sizeof(float), (void*)(2 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+
+        glBindVertexArray(0);
+        chunk.meshes.push_back(mesh);
+    }
+}
+
+void TileChunkCache::uploadFinished() {
+    std::vector<BuildResult> finished;
+    {
+        std::lock_guard<std::mutex> lock(m_mailbox->mutex);
+        size_t take = std::min(m_mailbox->finished.size(), static_cast<size_t>(kMaxUploadsPerFrame));
+        auto first = m_mailbox->finished.begin();
+        finished.assign(std::make_move_iterator(first), std::make_move_iterator(first + take));
+        m_mailbox->finished.erase(first, first + take);
+    }
+
+    for (auto& result : finished) {
+        m_pendingJobs--;
+
+        // Dropped if the chunk was cleared or edited again since the job was queued
+        auto it = m_chunks.find(result.key);
+        if (result.epoch == m_epoch && it != m_chunks.end() && it->second.generation == result.generation) {
+            uploadChunk(it->second, result);
+            it->second.builtGeneration = result.generation;
+            m_stats.chunksRebuilt++;
+            m_drawListDirty = true;
+        }
+    }
+
+    // Hand the staging buffers back for the next jobs
+    std::lock_guard<std::mutex> lock(m_mailbox->mutex);
+    for (auto& result : finished) {
+        result.vertices.clear();
+        m_mailbox->stagingPool.push_back(std::move(result.vertices));
+    }
+}
+
+void TileChunkCache::draw(const SpatialGrid& grid, const EntityStore& entities, const ChunkRange& range) {
+    m_stats = RenderStats{};
+
+    {
+        PROFILE_SCOPE("Chunk uploads");
+        uploadFinished();
+    }
+    dropEmptiedChunks(grid);
+
+    // Queue jobs for visible chunks that are missing or stale and not already being built
+    grid.forEachChunk(range, [&](int64_t key, const std::vector<uint32_t>& indices) {
+        auto [it, created] = m_chunks.try_emplace(key);
+        Chunk& chunk = it->second;
+        if (created) chunk.generation = ++m_nextGeneration;
+        if (chunk.builtGeneration != chunk.generation && chunk.queuedGeneration != chunk.generation) {
+            std::vector<Entity> tiles;
+            tiles.reserve(indices.size());
+            for (uint32_t index : indices) tiles.push_back(entities.entity(index));
+            queueChunk(key, chunk, std::move(tiles), grid.getCellWidth(), grid.getCellHeight());
+        }
+    });
+
+    if (m_drawListDirty || range != m_drawListRange) {
+        std::vector<DrawItem> items;
+        m_queue.clear();
+        grid.forEachChunk(range, [&](int64_t key, const std::vector<uint32_t>&) {
+            auto chunk = m_chunks.find(key);
+            if (chunk == m_chunks.end()) return;
+            for (auto& mesh : chunk->second.meshes) {
+                m_queue.push(runKey(mesh.layer, mesh.texture, mesh.asset), static_cast<uint32_t>(items.size()));
+                items.push_back({ mesh.layer, mesh.texture, mesh.asset, mesh.vao, mesh.indexCount });
+            }
+        });
+
+        // Layers must draw in order across all chunks; texture second saves rebinds
+        m_queue.sort();
+        m_drawList.clear();
+        for (auto& item : m_queue.items()) {
+            m_drawList.push_back(items[item.index]);
+        }
+        m_drawListRange = range;
+        m_drawListDirty = false;
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+
+    GLuint boundTexture = 0;
+    for (auto& item : m_drawList) {
+        // Slot lookup: whatever is resident now, the placeholder until then
+        GLuint texture = item.asset != kNoAsset ? AssetManager::GetGPUHandleOrPlaceholder(item.asset) : item.texture;
+        if (texture != boundTexture) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            boundTexture = texture;
+            m_stats.textureBinds++;
+        }
+        glBindVertexArray(item.vao);
+        glDrawElements(GL_TRIANGLES, item.indexCount, GL_UNSIGNED_INT, 0);
+        m_stats.drawCalls++;
+        m_stats.sprites += item.indexCount / 6;
+    }
+    m_stats.vertices = m_stats.sprites * 4;
+    m_stats.chunks = static_cast<int>(m_chunks.size());
+    m_stats.chunksPending = m_pendingJobs;
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include "EntityStore.h"
+#include "RenderSettings.h"
+#include "SpatialGrid.h"
+#include "RenderQueue.h"
+#include "WorkerPool.h"
+
+/**
+ * TileChunkCache: Keeps a static GPU mesh per (chunk, layer, texture) for the chunks of
+ * a SpatialGrid. Edits only invalidate the chunk they touch; meshes are (re)built lazily
+ * the first time their chunk is visible, so idle frames just replay the cached draw
+ * list and painting one tile rebuilds one chunk.
+ *
+ * Vertex generation runs on a WorkerPool: each job gets a snapshot of its chunk's tiles
+ * and writes into its own staging buffer, and draw() only uploads finished jobs. A chunk
+ * keeps drawing its previous mesh until the rebuilt one arrives.
+ *
+ * Tiles outside the atlas keep their asset id rather than a GL handle, looked up each
+ * frame, so a texture becoming resident or being evicted doesn't rebuild anything.
+ */
+class TileChunkCache {
+public:
+    explicit TileChunkCache(WorkerPool& workers);
+    ~TileChunkCache();
+
+    TileChunkCache(const TileChunkCache&) = delete;
+    TileChunkCache& operator=(const TileChunkCache&) = delete;
+
+    /**
+     * Invalidate: Marks the mesh of one chunk stale; it is rebuilt next time it is drawn,
+     * or dropped then if the grid no longer has the chunk (its last tile was removed).
+     */
+    void invalidate(int64_t key);
+
+    /**
+     * Clear: Drops every mesh (scene load, cell size change). Jobs still in flight are
+     * discarded when they finish.
+     */
+    void clear();
+
+    /**
+     * Draw: Uploads finished jobs, queues jobs for stale or missing chunks of `grid` inside
+     * `range` (tiles read from `entities`), then draws what is ready layer by layer with the
+     * currently bound sprite shader.
+     */
+    void draw(const SpatialGrid& grid, const EntityStore& entities, const ChunkRange& range);
+
+    // Jobs queued or running; the caller keeps rendering frames until this reaches 0
+    int pendingJobs() const { return m_pendingJobs; }
+
+    const RenderStats& getStats() const { return m_stats; }
+
+private:
+    struct Mesh {
+        int layer = 0;
+        GLuint texture = 0;                  // Atlas page, if asset is kNoAsset
+        AssetId asset = kNoAsset;            // Not in the atlas: own texture, resolved at draw time
+        GLuint vao = 0;
+        GLuint vbo = 0;
+        GLsizei indexCount = 0;
+    };
+
+    struct Chunk {
+        std::vector<Mesh> meshes;
+        uint32_t generation = 0;             // From m_nextGeneration, on creation and by invalidate()
+        uint32_t builtGeneration = ~0u;      // Generation the current meshes were built from
+        uint32_t queuedGeneration = ~0u;     // Generation of the job in flight, if any
+    };
+
+    // One entry of the layer-sorted list replayed every frame
+    struct DrawItem {
+        int layer;
+        GLuint texture;
+        AssetId asset;
+        GLuint vao;
+        GLsizei indexCount;
+    };
+
+    // Worker output: all runs of a chunk back to back in one staging buffer
+    struct BuildRun {
+        int layer;
+        GLuint texture;
+        AssetId asset;
+        size_t firstQuad;
+        size_t quadCount;
+    };
+
+    struct BuildResult {
+        int64_t key = 0;
+        uint32_t generation = 0;
+        uint64_t epoch = 0;
+        std::vector<float> vertices;
+        std::vector<BuildRun> runs;
+    };
+
+    // Shared with the jobs, so it outlives the cache if jobs are still running at shutdown
+    struct Mailbox {
+        std::mutex mutex;
+        std::vector<BuildResult> finished;
+        std::vector<std::vector<float>> stagingPool; // Recycled staging buffers
+    };
+
+    static void generateChunk(const std::vector<Entity>& tiles, float cellWidth, float cellHeight, BuildResult& result);
+    void queueChunk(int64_t key, Chunk& chunk, std::vector<Entity> tiles, float cellWidth, float cellHeight);
+    void uploadFinished();
+    void uploadChunk(Chunk& chunk, BuildResult& result);
+    void destroyMeshes(Chunk& chunk);
+    void dropEmptiedChunks(const SpatialGrid& grid);
+    void ensureIndexCapacity(size_t quads);
+
+    WorkerPool& m_workers;
+    std::shared_ptr<Mailbox> m_mailbox;
+    int m_pendingJobs = 0;
+    uint64_t m_epoch = 0; // Bumped by clear(), results from an older epoch are dropped
+    // Cache-wide, so a chunk erased and created again never reuses a generation a job in
+    // flight for the old one still carries
+    uint32_t m_nextGeneration = 0;
+
+    std::unordered_map<int64_t, Chunk> m_chunks;
+    std::vector<int64_t> m_invalidated; // Keys invalidated since the last draw, checked for emptied chunks
+    std::vector<DrawItem> m_drawList;
+    RenderQueue m_queue;
+    ChunkRange m_drawListRange;
+    bool m_drawListDirty = true;
+
+    GLuint m_ebo = 0;         // Shared quad index pattern for every mesh
+    size_t m_eboQuads = 0;
+
+    RenderStats m_stats;
+};
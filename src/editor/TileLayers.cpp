@@ -0,0 +1,136 @@
+#include "TileLayers.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Floor division, so negative cells land in the chunk to their left / below
+    int floorDiv(int value, int divisor) {
+        int q = value / divisor;
+        return (value % divisor != 0 && value < 0) ? q - 1 : q;
+    }
+}
+
+bool TileLayers::setCellSize(float cellWidth, float cellHeight) {
+    if (cellWidth == m_cellWidth && cellHeight == m_cellHeight) return false;
+    m_cellWidth = cellWidth;
+    m_cellHeight = cellHeight;
+    return true;
+}
+
+CellCoord TileLayers::cellAt(float x, float y) const {
+    return { static_cast<int>(std::floor(x / m_cellWidth)), static_cast<int>(std::floor(y / m_cellHeight)) };
+}
+
+void TileLayers::cellCentre(CellCoord cell, float& x, float& y) const {
+    x = cell.x * m_cellWidth + m_cellWidth * 0.5f;
+    y = cell.y * m_cellHeight + m_cellHeight * 0.5f;
+}
+
+void TileLayers::clear() {
+    m_chunks.clear();
+    m_stacked.clear();
+    m_layers.clear();
+    m_tileCount = 0;
+}
+
+void TileLayers::rebuild(const EntityStore& entities) {
+    clear();
+    for (auto& archetype : entities.archetypes()) {
+        for (size_t row = 0; row < archetype.size(); row++) {
+            CellCoord cell = cellAt(archetype.x[row], archetype.y[row]);
+            int layer = archetype.layer[row];
+            if (!place(layer, cell, archetype.type[row], archetype.index[row]))
+                m_stacked.emplace(ChunkKey{ layer, cell.x, cell.y }, Stacked{ archetype.type[row], archetype.index[row] });
+        }
+    }
+}
+
+TileLayers::ChunkKey TileLayers::keyFor(int layer, CellCoord cell, int& outIndex) {
+    int cx = floorDiv(cell.x, kChunkCells);
+    int cy = floorDiv(cell.y, kChunkCells);
+    outIndex = (cell.y - cy * kChunkCells) * kChunkCells + (cell.x - cx * kChunkCells);
+    return { layer, cx, cy };
+}
+
+const TileLayers::Chunk* TileLayers::chunkFor(int layer, CellCoord cell, int& outIndex) const {
+    auto it = m_chunks.find(keyFor(layer, cell, outIndex));
+    return it != m_chunks.end() ? &it->second : nullptr;
+}
+
+bool TileLayers::place(int layer, CellCoord cell, AssetId type, uint32_t entity) {
+    int index;
+    Chunk& chunk = m_chunks[keyFor(layer, cell, index)];
+    if (chunk.has(index)) return false;
+
+    chunk.types[index] = type;
+    chunk.entities[index] = entity;
+    chunk.occupied[index >> 6] |= uint64_t(1) << (index & 63);
+    chunk.count++;
+    m_tileCount++;
+
+    auto it = std::lower_bound(m_layers.begin(), m_layers.end(), layer);
+    if (it == m_layers.end() || *it != layer) m_layers.insert(it, layer);
+    return true;
+}
+
+bool TileLayers::remove(int layer, CellCoord cell, uint32_t entity) {
+    int index;
+    auto it = m_chunks.find(keyFor(layer, cell, index));
+    if (it == m_chunks.end() || !it->second.has(index)) return false;
+
+    Chunk& chunk = it->second;
+    auto [first, last] = m_stacked.equal_range(ChunkKey{ layer, cell.x, cell.y });
+    if (chunk.entities[index] != entity) {
+        // Not the tile in the cell: one of those stacked under it, if anything
+        for (auto stacked = first; stacked != last; ++stacked) {
+            if (stacked->second.entity == entity) {
+                m_stacked.erase(stacked);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (first != last) {
+        // Next tile of the stack takes the cell over
+        chunk.types[index] = first->second.type;
+        chunk.entities[index] = first->second.entity;
+        m_stacked.erase(first);
+        return true;
+    }
+
+    chunk.occupied[index >> 6] &= ~(uint64_t(1) << (index & 63));
+    chunk.count--;
+    m_tileCount--;
+    if (chunk.count == 0) m_chunks.erase(it);
+    return true;
+}
+
+bool TileLayers::occupied(int layer, CellCoord cell) const {
+    int index;
+    const Chunk* chunk = chunkFor(layer, cell, index);
+    return chunk && chunk->has(index);
+}
+
+AssetId TileLayers::typeAt(int layer, CellCoord cell) const {
+    int index;
+    const Chunk* chunk = chunkFor(layer, cell, index);
+    return (chunk && chunk->has(index)) ? chunk->types[index] : kNoAsset;
+}
+
+uint32_t TileLayers::entityAt(int layer, CellCoord cell) const {
+    int index;
+    const Chunk* chunk = chunkFor(layer, cell, index);
+    return (chunk && chunk->has(index)) ? chunk->entities[index] : kNoEntity;
+}
+
+bool TileLayers::topLayerAt(CellCoord cell, int& outLayer) const {
+    // A probe per layer in use, a handful in practice
+    for (auto it = m_layers.rbegin(); it != m_layers.rend(); ++it) {
+        if (occupied(*it, cell)) {
+            outLayer = *it;
+            return true;
+        }
+    }
+    return false;
+}
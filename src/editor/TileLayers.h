@@ -0,0 +1,109 @@
+#pragma once
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include "EntityStore.h"
+
+// Integer grid cell: column x, row y, cell (0, 0) spans [0, cellWidth) x [0, cellHeight)
+struct CellCoord {
+    int x = 0;
+    int y = 0;
+};
+
+/**
+ * TileLayers: Which tile sits in each grid cell, per layer. Cells are grouped into
+ * kChunkCells x kChunkCells chunks kept in a hash map keyed by (layer, chunk), so only
+ * painted areas cost memory; inside a chunk every cell has a fixed slot holding its asset
+ * id and entity index (EntityHandle::index), with an occupancy bitset. Placement, removal
+ * and lookups are one hash probe plus an index, whatever the size of the map. The
+ * EntityStore still owns the entities; this is the index placement goes through.
+ */
+class TileLayers {
+public:
+    static constexpr int kChunkCells = 32;
+    static constexpr uint32_t kNoEntity = EntityHandle::kInvalidIndex;
+
+    /**
+     * Set cell size: Returns true if it changed, in which case the caller must rebuild()
+     * so tiles are indexed by their new cells.
+     */
+    bool setCellSize(float cellWidth, float cellHeight);
+
+    CellCoord cellAt(float x, float y) const;
+    // World position of a cell's centre, where placed tiles go
+    void cellCentre(CellCoord cell, float& x, float& y) const;
+
+    void clear();
+    /**
+     * Rebuild: Indexes every entity by the cell under its position. Tiles sharing a cell
+     * and layer (off-grid ones after a cell size change, or from an old map) are stacked:
+     * the first is in the cell, the rest wait in an overflow list and move into the cell
+     * one by one as the tile in it is removed, so every entity stays reachable.
+     */
+    void rebuild(const EntityStore& entities);
+
+    // Place: Records the tile; false (and nothing changes) if the cell is already taken
+    bool place(int layer, CellCoord cell, AssetId type, uint32_t entity);
+    /**
+     * Remove: Drops `entity` from the cell, or from the cell's stack if it is waiting
+     * there; false if it was in neither. A stacked tile takes over the emptied cell.
+     */
+    bool remove(int layer, CellCoord cell, uint32_t entity);
+
+    bool occupied(int layer, CellCoord cell) const;
+    AssetId typeAt(int layer, CellCoord cell) const;         // kNoAsset if empty
+    uint32_t entityAt(int layer, CellCoord cell) const;      // kNoEntity if empty
+
+    // Highest layer with a tile in `cell`; false if every layer is empty there
+    bool topLayerAt(CellCoord cell, int& outLayer) const;
+
+    size_t tileCount() const { return m_tileCount + m_stacked.size(); }
+    size_t stackedCount() const { return m_stacked.size(); }
+    size_t chunkCount() const { return m_chunks.size(); }
+
+private:
+    static constexpr int kCellsPerChunk = kChunkCells * kChunkCells;
+
+    struct Chunk {
+        std::array<AssetId, kCellsPerChunk> types;
+        std::array<uint32_t, kCellsPerChunk> entities;
+        std::array<uint64_t, kCellsPerChunk / 64> occupied{};
+        int count = 0;
+
+        bool has(int index) const { return (occupied[index >> 6] >> (index & 63)) & 1; }
+    };
+
+    struct ChunkKey {
+        int layer;
+        int cx, cy;
+        bool operator==(const ChunkKey& o) const { return layer == o.layer && cx == o.cx && cy == o.cy; }
+    };
+
+    struct ChunkKeyHash {
+        size_t operator()(const ChunkKey& k) const {
+            uint64_t h = (static_cast<uint64_t>(static_cast<uint32_t>(k.cx)) << 32) | static_cast<uint32_t>(k.cy);
+            h ^= static_cast<uint64_t>(static_cast<uint32_t>(k.layer)) * 0x9e3779b97f4a7c15ull;
+            h ^= h >> 29;
+            return static_cast<size_t>(h * 0xbf58476d1ce4e5b9ull);
+        }
+    };
+
+    // A tile of a cell that was already taken when rebuild() reached it
+    struct Stacked {
+        AssetId type;
+        uint32_t entity;
+    };
+
+    // Chunk key and the cell's slot inside that chunk
+    static ChunkKey keyFor(int layer, CellCoord cell, int& outIndex);
+    const Chunk* chunkFor(int layer, CellCoord cell, int& outIndex) const;
+
+    std::unordered_map<ChunkKey, Chunk, ChunkKeyHash> m_chunks;
+    std::unordered_multimap<ChunkKey, Stacked, ChunkKeyHash> m_stacked; // Keyed by (layer, cell), not chunk
+    std::vector<int> m_layers; // Sorted; every layer that had a tile since the last clear
+    float m_cellWidth = 16.0f;
+    float m_cellHeight = 16.0f;
+    size_t m_tileCount = 0;
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+/**
+ * WorkerPool: A fixed set of threads pulling jobs off one FIFO queue. Jobs must not touch
+ * GL (the context lives on the main thread); they produce CPU data that the main thread
+ * picks up and uploads. The destructor finishes queued jobs before joining.
+ */
+class WorkerPool {
+public:
+    /**
+     * Constructor: threadCount 0 means one thread per core, minus the main thread.
+     */
+    explicit WorkerPool(unsigned int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void submit(std::function<void()> job);
+
+    size_t threadCount() const { return m_threads.size(); }
+
+    // Jobs queued but not started yet
+    size_t queuedJobs() const;
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    bool m_stopping = false;
+};
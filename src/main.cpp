@@ -1,10 +1,22 @@
-
 #include "./Editor/Editor.h"
 #include "window.h"
+#include <cstdlib>
+#include <string>
+
+int main(int argc, char** argv) {
+    // --texture-budget-mb N: load textures on first use and keep about N MB of them resident
+    // --no-asset-pack: decode the PNGs instead of loading src/assets.t2dpack
+    TextureStreamSettings textures;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--texture-budget-mb" && i + 1 < argc)
+            textures.residencyBudgetBytes = std::strtoul(argv[++i], nullptr, 10) * 1024 * 1024;
+        else if (arg == "--no-asset-pack")
+            textures.assetPack = false;
+    }
 
-int main() {
     Window window(1280, 720, "Tile2D");
-    Editor editor(window);
+    Editor editor(window, textures);
     editor.run();
     return 0;
 }
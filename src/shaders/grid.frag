@@ -1,6 +1,39 @@
 #version 330 core
+in vec2 vWorld;
 out vec4 FragColor;
 uniform vec3 uColor;
+uniform vec2 uCellSize;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
+
+const float kLodFactor = 4.0;    // Each coarser level groups 4x4 cells
+const float kMinSpacingPx = 8.0; // Finest level fades out below this on-screen spacing
+
+// Coverage of a ~1px line every `spacing` world units, anti-aliased with derivatives
+float lineCoverage(vec2 spacing) {
+    vec2 coord = vWorld / spacing;
+    vec2 dist = abs(fract(coord - 0.5) - 0.5) / fwidth(coord);
+    return 1.0 - min(min(dist.x, dist.y), 1.0);
+}
+
 void main() {
-    FragColor = vec4(uColor, 1.0);
+    float pixelsPerUnit = uViewport.w / (uViewRect.w - uViewRect.y);
+    float cellPx = min(uCellSize.x, uCellSize.y) * pixelsPerUnit;
+
+    // Continuous LOD: 0 while cells are >= kMinSpacingPx * kLodFactor on screen, +1 each
+    // time they shrink by kLodFactor. The fractional part fades the finer level out.
+    float lod = max(0.0, log2(kMinSpacingPx / cellPx) / log2(kLodFactor) + 1.0);
+    float level = floor(lod);
+    float fade = fract(lod);
+
+    vec2 spacing = uCellSize * pow(kLodFactor, level);
+    float fine = lineCoverage(spacing) * (1.0 - fade);
+    float coarse = lineCoverage(spacing * kLodFactor);
+
+    float alpha = max(fine, coarse);
+    if (alpha <= 0.0) discard;
+    FragColor = vec4(uColor, alpha);
 }
@@ -1,6 +1,13 @@
 #version 330 core
 layout (location = 0) in vec2 aPos;
-uniform mat4 uProjection;
+out vec2 vWorld;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
 void main() {
-    gl_Position = uProjection * vec4(aPos, 0.0, 1.0);
+    // aPos covers the whole viewport in NDC; map it onto the visible world rect
+    vWorld = mix(uViewRect.xy, uViewRect.zw, aPos * 0.5 + 0.5);
+    gl_Position = vec4(aPos, 0.0, 1.0);
 }
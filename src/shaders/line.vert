@@ -0,0 +1,10 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
+void main() {
+    gl_Position = uViewProjection * vec4(aPos, 0.0, 1.0);
+}
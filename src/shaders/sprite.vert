@@ -2,8 +2,12 @@
 layout (location = 0) in vec2 aPos;
 layout (location = 1) in vec2 aTex;
 out vec2 TexCoord;
-uniform mat4 uMVP;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
 void main() {
     TexCoord = aTex;
-    gl_Position = uMVP * vec4(aPos, 0.0, 1.0);
+    gl_Position = uViewProjection * vec4(aPos, 0.0, 1.0);
 }
@@ -0,0 +1,13 @@
+#version 330 core
+in vec2 TexCoord;
+flat in float Layer;
+out vec4 FragColor;
+uniform sampler2D uTexture;          // Fallback for textures that aren't in the array
+uniform sampler2DArray uTextureArray;
+void main() {
+    // Same branch for every fragment of a draw call, so it doesn't diverge
+    if (Layer >= 0.0)
+        FragColor = texture(uTextureArray, vec3(TexCoord, Layer));
+    else
+        FragColor = texture(uTexture, TexCoord);
+}
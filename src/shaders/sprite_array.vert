@@ -0,0 +1,16 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+layout (location = 2) in float aLayer; // Texture array layer, -1 = use uTexture
+out vec2 TexCoord;
+flat out float Layer;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
+void main() {
+    TexCoord = aTex;
+    Layer = aLayer;
+    gl_Position = uViewProjection * vec4(aPos, 0.0, 1.0);
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTex;
+layout (location = 2) in vec3 iPosDepth;
+layout (location = 3) in uint iRegion;
+out vec2 TexCoord;
+layout(std140) uniform Camera {
+    mat4 uViewProjection;
+    vec4 uViewRect;  // left, bottom, right, top in world units
+    vec4 uViewport;  // x, y, width, height in pixels
+};
+uniform vec2 uCellSize;
+uniform samplerBuffer uRegions;
+void main() {
+    vec4 uvRect = texelFetch(uRegions, int(iRegion));
+    TexCoord = mix(uvRect.xy, uvRect.zw, aTex);
+    gl_Position = uViewProjection * vec4(iPosDepth.xy + aPos * uCellSize, iPosDepth.z, 1.0);
+}
@@ -1,3 +1,13 @@
 // stb_impl.cpp
+// Textures decode on several threads at once; this stb_image version keeps the failure
+// reason in a global, so leave the strings out (stbi_failure_reason() returns null)
+#define STBI_NO_FAILURE_STRINGS
+
+// Decoder memory comes from the decoding thread's scratch arena (see PixelArena)
+#include "editor/PixelArena.h"
+#define STBI_MALLOC(size) PixelArena::StbMalloc(size)
+#define STBI_REALLOC(block, size) PixelArena::StbRealloc(block, size)
+#define STBI_FREE(block) PixelArena::StbFree(block)
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
@@ -12,9 +12,15 @@ static void framebuffer_size_callback(GLFWwindow*, int width, int height) {
  * framebuffer resize callback. Exits program on failure. This is the main window
  * that all rendering happens in.
  */
-Window::Window(int width, int height, const std::string& title)
+Window::Window(int width, int height, const std::string& title, WindowMode mode)
     : m_width(width), m_height(height)
 {
+#ifdef GLFW_PLATFORM_NULL
+    // GLFW 3.4+: the null platform needs no X11/Wayland/desktop, the context comes from OSMesa or EGL
+    if (mode == WindowMode::Headless && glfwPlatformSupported(GLFW_PLATFORM_NULL))
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#endif
+
     if (!glfwInit()) {
 
         std::cerr << "Failed to initialize GLFW\n";
@@ -24,8 +30,23 @@ Window::Window(int width, int height, const std::string& title)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_COMPAT_PROFILE);
+    if (mode != WindowMode::Visible)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+#ifdef GLFW_PLATFORM_NULL
+    if (mode == WindowMode::Headless && glfwGetPlatform() == GLFW_PLATFORM_NULL) {
+        // Software rendering (llvmpipe) through OSMesa first, EGL surfaceless second
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+        m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        if (!m_window) {
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+            m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+        }
+    }
+#endif
 
-    m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
+    if (!m_window)
+        m_window = glfwCreateWindow(width, height, title.c_str(), nullptr, nullptr);
     if (!m_window) {
         std::cerr << "Failed to create GLFW window\n";
         glfwTerminate();
@@ -64,6 +85,15 @@ void Window::pollEvents() const {
     glfwPollEvents();
 }
 
+/**
+ * Wait events: Like pollEvents(), but sleeps until at least one event arrives or
+ * timeoutSeconds pass. Used by the editor's on-demand loop so an idle window
+ * doesn't burn a CPU core.
+ */
+void Window::waitEvents(double timeoutSeconds) const {
+    glfwWaitEventsTimeout(timeoutSeconds);
+}
+
 /**
  * Swap buffers: Swaps the front and back buffers for double buffering.
  * Called at the end of each frame to display what was rendered. This is what
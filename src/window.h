@@ -7,6 +7,13 @@
 #include <string>
 
 
+// How the window is created. Hidden and Headless are for tools (the benchmark) that
+// render without anyone looking at the result.
+enum class WindowMode {
+    Visible,
+    Hidden,   // Normal window and context, just never shown
+    Headless, // No display needed: GLFW null platform with an OSMesa (or EGL) context if available, else Hidden
+};
 
 class Window {
 public:
@@ -16,7 +23,7 @@ public:
      * framebuffer resize callback. Exits program on failure. This is the main window
      * that all rendering happens in.
      */
-    Window(int width, int height, const std::string& title);
+    Window(int width, int height, const std::string& title, WindowMode mode = WindowMode::Visible);
     
     /**
      * Destructor: Destroys the GLFW window and terminates GLFW.
@@ -31,6 +38,13 @@ public:
      * makes input callbacks fire and updates the window state.
      */
     void pollEvents() const;
+
+    /**
+     * Wait events: Like pollEvents(), but sleeps until at least one event arrives or
+     * timeoutSeconds pass. Used by the editor's on-demand loop so an idle window
+     * doesn't burn a CPU core.
+     */
+    void waitEvents(double timeoutSeconds) const;
     
     /**
      * Swap buffers: Swaps the front and back buffers for double buffering.